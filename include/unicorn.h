@@ -62,6 +62,7 @@ typedef enum unistat
     UNI_BAD_OPERATION,
     UNI_FEATURE_DISABLED,
     UNI_MALFUNCTION,
+    UNI_TOO_LONG,
 } unistat;
 
 typedef uint32_t uniattr;
@@ -87,6 +88,39 @@ typedef uint32_t uniattr;
 
 #define UNI_TRUST 0x40u
 #define UNI_NULIFY 0x80u
+#define UNI_REPLACE 0x100u
+#define UNI_LATIN1 0x200u
+#define UNI_CP1252 0x400u
+#define UNI_SINK 0x800u
+#define UNI_ALLOC 0x1000u
+#define UNI_SHRINK 0x2000u
+#define UNI_CURSOR 0x4000u
+
+typedef struct uniview
+{
+    const void *text;
+    unisize text_len;
+    uniattr text_attr;
+} uniview;
+
+typedef unistat (*unisinkfunc)(void *user_data, const void *data, unisize data_len);
+
+typedef struct unisink
+{
+    unisinkfunc write;
+    void *user_data;
+    void *buffer;
+    unisize buffer_len;
+} unisink;
+
+typedef struct unicursor
+{
+    void *buffer;
+    unisize buffer_len;
+    unisize index;
+    unisize skip;
+    int32_t state;
+} unicursor;
 
 //
 // Unicode and Library Version
@@ -103,6 +137,14 @@ typedef void *(*unimemfunc)(void *user_data, void *ptr, size_t old_size, size_t
 
 UNICORN_API unistat uni_setmemfunc(void *user_data, unimemfunc allocf);
 
+typedef struct unibuf
+{
+    void *data;
+    size_t size;
+} unibuf;
+
+UNICORN_API void uni_freebuf(unibuf *buf);
+
 //
 // Logging
 //
@@ -111,6 +153,65 @@ typedef void(*unierrfunc)(void *user_data, const char *message);
 
 UNICORN_API void uni_seterrfunc(void *user_data, unierrfunc callback);
 
+//
+// Context
+//
+
+typedef struct unicontext
+{
+    unimemfunc allocf;
+    void *alloc_data;
+    unierrfunc errf;
+    void *err_data;
+    uint32_t options;
+} unicontext;
+
+#define UNI_NO_HEAP 0x1u
+
+UNICORN_API unistat uni_setcontext(const unicontext *context);
+UNICORN_API const unicontext *uni_getcontext(void);
+
+//
+// Arena Allocator
+//
+
+typedef struct uniarena uniarena;
+
+UNICORN_API unistat uni_arena_create(size_t block_size, uniarena **arena);
+UNICORN_API void uni_arena_reset(uniarena *arena);
+UNICORN_API void uni_arena_destroy(uniarena *arena);
+UNICORN_API void *uni_arena_alloc(void *user_data, void *ptr, size_t old_size, size_t new_size);
+
+//
+// Workspace
+//
+
+typedef struct uniworkspace uniworkspace;
+
+UNICORN_API unistat uni_workspace_create(unisize capacity, uniworkspace **workspace);
+UNICORN_API void uni_workspace_destroy(uniworkspace *workspace);
+
+//
+// CPU Features
+//
+
+typedef uint32_t unicpu;
+
+#define UNI_CPU_SSE2 0x1u
+#define UNI_CPU_SSE42 0x2u
+#define UNI_CPU_AVX2 0x4u
+#define UNI_CPU_ALL 0xFFFFFFFFu
+
+UNICORN_API unicpu uni_getcpufeatures(void);
+UNICORN_API void uni_setcpufeatures(unicpu features);
+
+//
+// Parallel Processing
+//
+
+typedef void (*unitaskfunc)(void *task_data, unisize index);
+typedef void (*unirunfunc)(void *user_data, unitaskfunc task, void *task_data, unisize task_count);
+
 //
 // Case Conversion
 //
@@ -137,6 +238,8 @@ typedef enum unicasefold
 
 UNICORN_API unistat uni_casefold(unicasefold casing, const void *src, unisize src_len, uniattr src_attr, void *dst, unisize *dst_len, uniattr dst_attr);
 UNICORN_API unistat uni_casefoldcmp(unicasefold casing, const void *s1, unisize s1_len, uniattr s1_attr, const void *s2, unisize s2_len, uniattr s2_attr, bool *result);
+UNICORN_API unistat uni_casefoldcmpws(unicasefold casing, const void *s1, unisize s1_len, uniattr s1_attr, const void *s2, unisize s2_len, uniattr s2_attr, bool *result, uniworkspace *workspace);
+UNICORN_API unistat uni_viewcasefoldcmp(unicasefold casing, const uniview *v1, const uniview *v2, bool *result);
 UNICORN_API unistat uni_casefoldchk(unicasefold casing, const void *text, unisize text_len, uniattr text_attr, bool *result);
 
 //
@@ -165,8 +268,11 @@ typedef enum uniweighting
 } uniweighting;
 
 UNICORN_API unistat uni_sortkeymk(const void *text, unisize text_len, uniattr text_attr, uniweighting weighting, unistrength strength, uint16_t *sortkey, size_t *sortkey_cap);
+UNICORN_API unistat uni_sortkeymkws(const void *text, unisize text_len, uniattr text_attr, uniweighting weighting, unistrength strength, uint16_t *sortkey, size_t *sortkey_cap, uniworkspace *workspace);
 UNICORN_API unistat uni_sortkeycmp(const uint16_t *sk1, size_t sk1_len, const uint16_t *sk2, size_t sk2_len, int32_t *result);
 UNICORN_API unistat uni_collate(const void *s1, unisize s1_len, uniattr s1_attr, const void *s2, unisize s2_len, uniattr s2_attr, uniweighting weighting, unistrength strength, int32_t *result);
+UNICORN_API unistat uni_collatews(const void *s1, unisize s1_len, uniattr s1_attr, const void *s2, unisize s2_len, uniattr s2_attr, uniweighting weighting, unistrength strength, int32_t *result, uniworkspace *workspace);
+UNICORN_API unistat uni_viewcollate(const uniview *v1, const uniview *v2, uniweighting weighting, unistrength strength, int32_t *result);
 
 //
 // Normalization
@@ -186,7 +292,10 @@ typedef enum uninormchk
 } uninormchk;
 
 UNICORN_API unistat uni_norm(uninormform form, const void *src, unisize src_len, uniattr src_attr, void *dst, unisize *dst_len, uniattr dst_attr);
+UNICORN_API unistat uni_normws(uninormform form, const void *src, unisize src_len, uniattr src_attr, void *dst, unisize *dst_len, uniattr dst_attr, uniworkspace *workspace);
+UNICORN_API unistat uni_normif(uninormform form, const void *src, unisize src_len, uniattr src_attr, void *dst, unisize *dst_len, uniattr dst_attr, bool *changed);
 UNICORN_API unistat uni_normcmp(const void *s1, unisize s1_len, uniattr s1_attr, const void *s2, unisize s2_len, uniattr s2_attr, bool *result);
+UNICORN_API unistat uni_viewnormcmp(const uniview *v1, const uniview *v2, bool *result);
 UNICORN_API unistat uni_normchk(uninormform form, const void *text, unisize text_len, uniattr text_attr, bool *result);
 UNICORN_API unistat uni_normqchk(uninormform form, const void *text, unisize text_len, uniattr text_attr, uninormchk *result);
 
@@ -194,11 +303,39 @@ UNICORN_API unistat uni_normqchk(uninormform form, const void *text, unisize tex
 // Text Iterators, Encoders, Decoders, and Validators
 //
 
+typedef struct unimark
+{
+    unisize utf8;
+    unisize utf16;
+    unisize utf32;
+} unimark;
+
+typedef struct univalidator
+{
+    uniattr text_attr;
+    unisize offset;
+    unisize start;
+    uint32_t state;
+    unistat status;
+} univalidator;
+
 UNICORN_API unistat uni_next(const void *text, unisize text_len, uniattr text_attr, unisize *index, unichar *cp);
 UNICORN_API unistat uni_prev(const void *text, unisize text_len, uniattr text_attr, unisize *index, unichar *cp);
 UNICORN_API unistat uni_encode(unichar cp, void *dst, unisize *dst_len, uniattr dst_attr);
 UNICORN_API unistat uni_convert(const void *src, unisize src_len, uniattr src_attr, void *dst, unisize *dst_len, uniattr dst_attr);
+UNICORN_API unistat uni_convertpar(const void *src, unisize src_len, uniattr src_attr, void *dst, unisize *dst_len, uniattr dst_attr, unisize chunk_len, unirunfunc run, void *user_data);
+UNICORN_API unistat uni_decode(const void *src, unisize src_len, uniattr src_attr, unichar *dst, unisize *dst_len, unisize *consumed);
 UNICORN_API unistat uni_validate(const void *text, unisize text_len, uniattr text_attr);
+UNICORN_API unistat uni_validatepar(const void *text, unisize text_len, uniattr text_attr, unisize chunk_len, unirunfunc run, void *user_data);
+UNICORN_API unistat uni_validateinit(univalidator *validator, uniattr text_attr);
+UNICORN_API unistat uni_validatefeed(univalidator *validator, const void *text, unisize text_len, unisize *offset);
+UNICORN_API unistat uni_validatefinish(univalidator *validator, unisize *offset);
+UNICORN_API unistat uni_count(const void *text, unisize text_len, uniattr text_attr, uniattr count_attr, unisize *count);
+UNICORN_API unistat uni_index(const void *text, unisize text_len, uniattr text_attr, unisize interval, unimark *marks, unisize *marks_len);
+UNICORN_API unistat uni_indexmap(const void *text, unisize text_len, uniattr text_attr, const unimark *marks, unisize marks_len, uniattr from_attr, unisize offset, uniattr to_attr, unisize *result);
+UNICORN_API unistat uni_view(const void *text, unisize text_len, uniattr text_attr, uniview *view);
+UNICORN_API unistat uni_viewnext(const uniview *view, unisize *index, unichar *cp);
+UNICORN_API unistat uni_viewprev(const uniview *view, unisize *index, unichar *cp);
 
 //
 // Text Segmentation
@@ -213,6 +350,8 @@ typedef enum unibreak
 
 UNICORN_API unistat uni_nextbrk(unibreak boundary, const void *text, unisize text_len, uniattr text_attr, unisize *index);
 UNICORN_API unistat uni_prevbrk(unibreak boundary, const void *text, unisize text_len, uniattr text_attr, unisize *index);
+UNICORN_API unistat uni_viewnextbrk(unibreak boundary, const uniview *view, unisize *index);
+UNICORN_API unistat uni_viewprevbrk(unibreak boundary, const uniview *view, unisize *index);
 
 //
 // Character Properties
@@ -46,6 +46,8 @@ from .case_folding import CanonicalCaseFolding
 from .encoding import EncodingUTF8
 from .encoding import EncodingUTF16
 from .encoding import EncodingUTF32
+from .encoding import EncodingLatin1
+from .encoding import EncodingCP1252
 
 from .ccc import CanonicalCombiningClass
 
@@ -111,6 +113,8 @@ def generate(args: GeneratorArgs, archive: zipfile.ZipFile) -> Tuple[str, str, s
     else:
         header += "#define UNICORN_OPTIMIZE_FOR_SIZE\n"
 
+    header += "#define UNICORN_CHAR_STORAGE_BITS {0} // cppcheck-suppress misra-c2012-2.5\n".format(config.character_storage_bytes() * 8)
+
     # Add case conversion.
     if config.algorithms.case_convert & CaseConvert.LOWER:
         klasses.add(LowercaseConversion)
@@ -211,6 +215,10 @@ def generate(args: GeneratorArgs, archive: zipfile.ZipFile) -> Tuple[str, str, s
         klasses.add(EncodingUTF16)
     if config.encoding_forms & EncodingForm.UTF32:
         klasses.add(EncodingUTF32)
+    if config.encoding_forms & EncodingForm.LATIN1:
+        klasses.add(EncodingLatin1)
+    if config.encoding_forms & EncodingForm.CP1252:
+        klasses.add(EncodingCP1252)
 
     # Gather up all dependencies.
     while True:
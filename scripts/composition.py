@@ -9,46 +9,125 @@
 #  Alternatively, you can license this software under a proprietary
 #  license, as set out in <https://railgunlabs.com/unicorn/license/>.
 
-from typing import List, Set, Tuple, Type
+from typing import Dict, List, Set, Tuple, Type
 import zipfile
 import json
+import re
 
 from .config import Config
 from .tools import Codepoint, Codespace
 from .feature import Feature, IS_COMPOSABLE, FLAGS_PROPERTY
-from .basics import StorageSize, SerializationData
+from .basics import SerializationData
 from .decomposition import CanonicalDecompositionFeature
 
+UINT32_MASK = 0xFFFFFFFF
+
+# Mirrors uni_hash_char() in src/common.h.
+def hash_char(cp: int) -> int:
+    h = cp
+    h = (((h >> 16) ^ h) * 0x45D9F3B) & UINT32_MASK
+    h = (((h >> 16) ^ h) * 0x45D9F3B) & UINT32_MASK
+    h = (h >> 16) ^ h
+    return h
+
+# Mirrors uni_xorshift() in src/common.h.
+def xorshift(x: int) -> int:
+    h = x & UINT32_MASK
+    h ^= (h << 13) & UINT32_MASK
+    h ^= h >> 17
+    h ^= (h << 5) & UINT32_MASK
+    return h
+
+# Mirrors hash_pair() in src/normalize.c.
+def hash_pair(starter: Codepoint, combining: Codepoint) -> int:
+    return hash_char(hash_char(starter) ^ combining)
+
+# Builds a minimal perfect hash table with the "hash, displace" algorithm: keys are
+# bucketed by their hash and each bucket, largest first, searches for a seed that
+# moves all of its keys to unoccupied slots.
+def perfect_hash(keys: List[int]) -> Tuple[List[int], List[int]]:
+    length = len(keys)
+    buckets: List[List[int]] = [[] for _ in range(length)]
+    for index, key in enumerate(keys):
+        buckets[key % length].append(index)
+
+    seeds = [0] * length
+    slots = [-1] * length
+    for bucket_index in sorted(range(length), key=lambda i: len(buckets[i]), reverse=True):
+        bucket = buckets[bucket_index]
+        if len(bucket) == 0:
+            break
+        seed = 1
+        while True:
+            positions = [xorshift(keys[i] + seed) % length for i in bucket]
+            if len(set(positions)) == len(positions) and all(slots[p] == -1 for p in positions):
+                break
+            seed += 1
+        assert seed <= 0xFFFF
+        seeds[bucket_index] = seed
+        for i, position in zip(bucket, positions):
+            slots[position] = i
+    return seeds, slots
+
 class CanonicalCompositionFeature(Feature):
     @staticmethod
     def dependencies() -> Set[Type[Feature]]:
         return set([CanonicalDecompositionFeature])
 
     def pre_process(self, codespace: Codespace) -> None:
-        codespace.register_property("canonical_composition_mapping_offset", 0, StorageSize.UINT16)
-        codespace.register_property("canonical_composition_mapping_count", 0, StorageSize.UINT8)
         codespace.register_property(*FLAGS_PROPERTY)
 
     def process(self, archive: zipfile.ZipFile, codespace: Codespace, config: Config) -> SerializationData:
         file = archive.open('composition.json')
         data = json.loads(file.read())
         mappings: List[Tuple[Codepoint,int,int]] = data["compositionMappings"]
-        size: int = data["compositionSize"]
         source: str = data["compositionSource"]
-        header: str = data["compositionHeader"]
         file.close()
 
-        offset_property = codespace.get("canonical_composition_mapping_offset")
-        count_property = codespace.get("canonical_composition_mapping_count")
+        # Extract the composition pairs. Each starter has a sorted array of the characters
+        # it composes with and the character they compose into.
+        table = [int(value, 16) for value in re.findall(r'UNICHAR_C\((0x[0-9A-Fa-f]+)\)', source)]
+        compositions: List[Tuple[Codepoint,Codepoint,Codepoint]] = []
         flags_property = codespace.get(FLAGS_PROPERTY[0])
-
         for value_triplet in mappings:
             first = value_triplet[0]
             offset = value_triplet[1]
             count = value_triplet[2]
-            codespace.set(first, offset_property, offset)
-            codespace.set(first, count_property, count)
+            for index in range(offset, offset + count):
+                compositions.append((first, table[index*2], table[(index*2)+1]))
             codespace.set_bitwise(first, flags_property, IS_COMPOSABLE)
 
+        # Compositions are looked up with a perfect hash of the pair of characters.
+        keys = [hash_pair(starter, combining) for starter, combining, _ in compositions]
+        assert len(set(keys)) == len(keys), "composition pairs must hash uniquely"
+        seeds, slots = perfect_hash(keys)
+
+        source = 'const uint16_t uni_canonical_comp_seeds[] = {'
+        for index, seed in enumerate(seeds):
+            if (index % 16) == 0:
+                source += '\n    '
+            source += '%d,' % seed
+        source += '\n};\n\n'
+
+        source += 'const struct CanonicalComposition uni_canonical_comps[] = {\n'
+        for slot in slots:
+            starter, combining, composed = compositions[slot]
+            source += '    { UNICHAR_C(0x%04X), UNICHAR_C(0x%04X), UNICHAR_C(0x%04X) },\n' % (starter, combining, composed)
+        source += '};\n'
+
+        header = ''
+        header += 'struct CanonicalComposition\n'
+        header += '{\n'
+        header += '    unichar starter;\n'
+        header += '    unichar combining;\n'
+        header += '    unichar composed;\n'
+        header += '};\n'
+        header += '#define CHAR_IS_COMPOSABLE 1u\n'
+        header += '#define CANONICAL_COMPOSITIONS_COUNT {0}\n'.format(len(compositions))
+        header += 'extern const uint16_t uni_canonical_comp_seeds[{0}];\n'.format(len(seeds))
+        header += 'extern const struct CanonicalComposition uni_canonical_comps[{0}];\n'.format(len(slots))
+
+        size = (len(seeds) * 2) + (len(slots) * config.character_storage_bytes() * 3)
+
         public_header = "#define UNICORN_FEATURE_NFC\n"
         return SerializationData(source, header, public_header, size)
@@ -47,6 +47,8 @@ class EncodingForm(enum.IntFlag):
     UTF8 = enum.auto()
     UTF16 = enum.auto()
     UTF32 = enum.auto()
+    LATIN1 = enum.auto()
+    CP1252 = enum.auto()
 
 class Segmentation(enum.IntFlag):
     NONE = enum.auto()
@@ -295,8 +297,12 @@ def parse(filename: Optional[str], archive: zipfile.ZipFile) -> Config:
                     config.encoding_forms |= EncodingForm.UTF16
                 elif encoding.lower() == "utf-32":
                     config.encoding_forms |= EncodingForm.UTF32
+                elif encoding.lower() in ("latin-1", "iso-8859-1"):
+                    config.encoding_forms |= EncodingForm.LATIN1
+                elif encoding.lower() in ("windows-1252", "cp1252"):
+                    config.encoding_forms |= EncodingForm.CP1252
                 else:
-                    print("warning: expected 'utf-8' or 'utf-16' or 'utf-32' for 'encodingForms'")
+                    print("warning: expected 'utf-8' or 'utf-16' or 'utf-32' or 'latin-1' or 'windows-1252' for 'encodingForms'")
         elif key == "characterProperties":
             if not isinstance(value, List):
                 print("error: expected string list for 'characterProperties'")
@@ -9,9 +9,10 @@
 #  Alternatively, you can license this software under a proprietary
 #  license, as set out in <https://railgunlabs.com/unicorn/license/>.
 
-from typing import List, Set, Type, Tuple
+from typing import Dict, List, Set, Type, Tuple
 import zipfile
 import json
+import re
 
 from .config import Config, OptimizeFor
 from .tools import Codepoint, Codespace
@@ -20,6 +21,56 @@ from .basics import StorageSize, SerializationData
 from .ccc import CanonicalCombiningClass
 from .encoding import EncodingUTF8
 
+def expand_decompositions(mappings: List[Tuple[Codepoint,int]], source: str, ccc: Dict[str,int]) -> Tuple[List[Tuple[Codepoint,int]], str, str, int]:
+    # Extract the single level decompositions from the table. Each decomposition is
+    # stored as its length followed by its characters.
+    table = [int(value, 16) for value in re.findall(r'UNICHAR_C\((0x[0-9A-Fa-f]+)\)', source)]
+    decompositions: Dict[Codepoint,List[Codepoint]] = {}
+    for cp, offset in mappings:
+        decompositions[cp] = table[offset+1:offset+1+table[offset]]
+
+    def expand(cp: Codepoint) -> List[Codepoint]:
+        if cp not in decompositions:
+            return [cp]
+        return [c for d in decompositions[cp] for c in expand(d)]
+
+    # The first entry is the empty decomposition for characters that don't decompose.
+    # Characters with identical decompositions share the same entry.
+    chars: List[Codepoint] = [0]
+    cccs: List[int] = [0]
+    offsets: Dict[Tuple[Codepoint, ...],int] = {}
+    expanded_mappings: List[Tuple[Codepoint,int]] = []
+    longest = 0
+    for cp, _ in mappings:
+        decomposition = tuple(expand(cp))
+        if decomposition not in offsets:
+            offsets[decomposition] = len(chars)
+            chars += [len(decomposition)] + list(decomposition)
+            cccs += [0] + [ccc.get('%04X' % c, 0) for c in decomposition]
+        expanded_mappings.append((cp, offsets[decomposition]))
+        longest = max(longest, len(decomposition))
+
+    source = 'const unichar uni_canonical_decomp_mappings[] = {'
+    for index, value in enumerate(chars):
+        if (index % 6) == 0:
+            source += '\n    '
+        source += 'UNICHAR_C(0x%02X), ' % value
+    source += '\n};\n\n'
+
+    source += 'const uint8_t uni_canonical_decomp_cccs[] = {'
+    for index, value in enumerate(cccs):
+        if (index % 8) == 0:
+            source += '\n    '
+        source += '%du, ' % value
+    source += '\n};\n'
+
+    header = ''
+    header += 'extern const unichar uni_canonical_decomp_mappings[{0}];\n'.format(len(chars))
+    header += 'extern const uint8_t uni_canonical_decomp_cccs[{0}];\n'.format(len(cccs))
+    header += '#define LONGEST_UNICHAR_DECOMPOSITION {0}\n'.format(longest)
+    header += '#define LONGEST_RAW_DECOMPOSITION {0}\n'.format(longest + 1)
+    return expanded_mappings, source, header, len(chars)
+
 class CanonicalDecompositionFeature(Feature):
     @staticmethod
     def dependencies() -> Set[Type[Feature]]:
@@ -41,9 +92,14 @@ class CanonicalDecompositionFeature(Feature):
         size: int = data["size"]
         file.close()
 
-        # Compute the size (in bytes) occupied by the decomposition mapping data.
+        # When optimizing for speed, the decompositions are fully expanded so a character
+        # decomposes with one table lookup rather than one per level of decomposition.
         if config.optimize == OptimizeFor.SPEED:
-            size *= config.character_storage_bytes()
+            file = archive.open('ccc.json')
+            ccc: Dict[str,int] = json.loads(file.read())["ccc"]
+            file.close()
+            mappings, source, header, size = expand_decompositions(mappings, source, ccc)
+            size *= config.character_storage_bytes() + 1 # Each character is stored with its CCC.
 
         # Associate code points with their canonical decomposition mapping.
         for mapping in mappings:
@@ -30,3 +30,13 @@ class EncodingUTF32(Feature):
     def process(self, archive: zipfile.ZipFile, codespace: Codespace, config: Config) -> SerializationData:
         public_header = "#define UNICORN_FEATURE_ENCODING_UTF32\n"
         return SerializationData(public_header=public_header)
+    
+class EncodingLatin1(Feature):
+    def process(self, archive: zipfile.ZipFile, codespace: Codespace, config: Config) -> SerializationData:
+        public_header = "#define UNICORN_FEATURE_ENCODING_LATIN1\n"
+        return SerializationData(public_header=public_header)
+    
+class EncodingCP1252(Feature):
+    def process(self, archive: zipfile.ZipFile, codespace: Codespace, config: Config) -> SerializationData:
+        public_header = "#define UNICORN_FEATURE_ENCODING_CP1252\n"
+        return SerializationData(public_header=public_header)
@@ -0,0 +1,251 @@
+/*
+ *  Unicorn - Embeddable Unicode Algorithms
+ *  Copyright (c) 2024-2026 Railgun Labs
+ *
+ *  This software is dual-licensed: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation. For the terms of this
+ *  license, see <https://www.gnu.org/licenses/>.
+ *
+ *  Alternatively, you can license this software under a proprietary
+ *  license, as set out in <https://railgunlabs.com/unicorn/license/>.
+ */
+
+#include "common.h"
+
+// Allocations are aligned to this boundary which is suitable for any scalar type.
+#define ARENA_ALIGNMENT ((size_t)16)
+
+// Size of the blocks when the caller doesn't specify one.
+#define ARENA_DEFAULT_BLOCK_SIZE ((size_t)65536)
+
+// Blocks are carved from the front to the back. Their memory immediately follows
+// this header, which is padded to the alignment of allocations.
+struct ArenaBlock
+{
+    struct ArenaBlock *next;
+    size_t capacity;
+    size_t used;
+};
+
+struct uniarena
+{
+    // Blocks in the order they're used. After a reset they're reused from the head.
+    struct ArenaBlock *head;
+    struct ArenaBlock *current;
+    size_t block_size;
+
+    // The most recent allocation. It's always in the current block and it's the only
+    // allocation that can be grown, shrunk, or freed in place.
+    unichar8 *last;
+};
+
+static size_t align_size(size_t size)
+{
+    return (size + (ARENA_ALIGNMENT - (size_t)1)) & ~(ARENA_ALIGNMENT - (size_t)1);
+}
+
+static size_t header_size(void)
+{
+    return align_size(sizeof(struct ArenaBlock));
+}
+
+static unichar8 *block_data(struct ArenaBlock *block)
+{
+    unichar8 *bytes = (unichar8 *)block; // cppcheck-suppress misra-c2012-11.3
+    return &bytes[header_size()];
+}
+
+static void free_block(struct ArenaBlock *block)
+{
+    uni_global_free(block, header_size() + block->capacity);
+}
+
+// Returns a block with room for 'size' bytes. The block after the current one is reused,
+// if it's large enough, otherwise a new block is allocated and linked after the current one.
+static struct ArenaBlock *next_block(struct uniarena *arena, size_t size)
+{
+    struct ArenaBlock *block = NULL;
+    struct ArenaBlock *next = (arena->current != NULL) ? arena->current->next : arena->head;
+
+    if ((next != NULL) && (next->capacity >= size))
+    {
+        block = next;
+        block->used = 0;
+    }
+    else if (size <= (SIZE_MAX - header_size()))
+    {
+        // Requests larger than the block size get a block of their own.
+        const size_t capacity = (size > arena->block_size) ? size : arena->block_size;
+        block = uni_global_malloc(header_size() + capacity); // cppcheck-suppress misra-c2012-11.5
+        if (block != NULL)
+        {
+            block->next = next;
+            block->capacity = capacity;
+            block->used = 0;
+            if (arena->current != NULL)
+            {
+                arena->current->next = block;
+            }
+            else
+            {
+                arena->head = block;
+            }
+        }
+    }
+    else
+    {
+        // No Action.
+    }
+
+    return block;
+}
+
+static void *arena_allocate(struct uniarena *arena, size_t size)
+{
+    unichar8 *ptr = NULL;
+
+    if (size <= (SIZE_MAX - ARENA_ALIGNMENT))
+    {
+        const size_t aligned = align_size(size);
+        struct ArenaBlock *block = arena->current;
+        if ((block == NULL) || ((block->capacity - block->used) < aligned))
+        {
+            block = next_block(arena, aligned);
+        }
+
+        if (block != NULL)
+        {
+            ptr = &block_data(block)[block->used];
+            block->used += aligned;
+            arena->current = block;
+            arena->last = ptr;
+        }
+    }
+
+    return ptr;
+}
+
+UNICORN_API unistat uni_arena_create(size_t block_size, uniarena **arena) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+{
+    unistat status = UNI_OK;
+
+    if (arena == NULL)
+    {
+        uni_message("required argument is null");
+        status = UNI_BAD_OPERATION;
+    }
+    else
+    {
+        uniarena *new_arena = uni_global_malloc(sizeof(uniarena)); // cppcheck-suppress misra-c2012-11.5
+        if (new_arena == NULL)
+        {
+            uni_message("memory allocation failed");
+            status = UNI_NO_MEMORY;
+        }
+        else
+        {
+            new_arena->head = NULL;
+            new_arena->current = NULL;
+            new_arena->block_size = (block_size == (size_t)0) ? ARENA_DEFAULT_BLOCK_SIZE : align_size(block_size);
+            new_arena->last = NULL;
+        }
+        *arena = new_arena;
+    }
+
+    return status;
+}
+
+UNICORN_API void uni_arena_reset(uniarena *arena) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+{
+    if (arena != NULL)
+    {
+        // Blocks of the configured size are kept for reuse whereas blocks
+        // that were allocated for oversized requests are released.
+        struct ArenaBlock **link = &arena->head;
+        while (*link != NULL)
+        {
+            struct ArenaBlock *block = *link;
+            if (block->capacity > arena->block_size)
+            {
+                *link = block->next;
+                free_block(block);
+            }
+            else
+            {
+                block->used = 0;
+                link = &block->next;
+            }
+        }
+        arena->current = arena->head;
+        arena->last = NULL;
+    }
+}
+
+UNICORN_API void uni_arena_destroy(uniarena *arena) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+{
+    if (arena != NULL)
+    {
+        struct ArenaBlock *block = arena->head;
+        while (block != NULL)
+        {
+            struct ArenaBlock *next = block->next;
+            free_block(block);
+            block = next;
+        }
+        uni_global_free(arena, sizeof(uniarena));
+    }
+}
+
+UNICORN_API void *uni_arena_alloc(void *user_data, void *ptr, size_t old_size, size_t new_size) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+{
+    uniarena *arena = user_data; // cppcheck-suppress misra-c2012-11.5
+    unichar8 *bytes = ptr; // cppcheck-suppress misra-c2012-11.5
+    void *new_ptr = NULL;
+
+    if (bytes == NULL)
+    {
+        new_ptr = arena_allocate(arena, new_size);
+    }
+    else if (bytes == arena->last)
+    {
+        // The most recent allocation is resized, or freed, in place by moving the top of the block.
+        // Buffers that grow one reallocation at a time, like the character vectors and allocated
+        // output buffers, therefore rarely copy their contents.
+        struct ArenaBlock *block = arena->current;
+        const size_t offset = (size_t)(bytes - block_data(block));
+        if (new_size == (size_t)0)
+        {
+            block->used = offset;
+            arena->last = NULL;
+        }
+        else if ((new_size <= (SIZE_MAX - ARENA_ALIGNMENT)) && (align_size(new_size) <= (block->capacity - offset)))
+        {
+            block->used = offset + align_size(new_size);
+            new_ptr = bytes;
+        }
+        else
+        {
+            new_ptr = arena_allocate(arena, new_size);
+            if (new_ptr != NULL)
+            {
+                (void)memcpy(new_ptr, bytes, old_size);
+            }
+        }
+    }
+    else if (new_size > (size_t)0)
+    {
+        // Other allocations are moved. Their memory is reclaimed when the arena is reset.
+        new_ptr = arena_allocate(arena, new_size);
+        if (new_ptr != NULL)
+        {
+            (void)memcpy(new_ptr, bytes, (old_size < new_size) ? old_size : new_size);
+        }
+    }
+    else
+    {
+        // No Action.
+    }
+
+    return new_ptr;
+}
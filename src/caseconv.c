@@ -60,7 +60,7 @@ static void final_sigma_before(struct unitext input, bool *match)
     do
     {
         cp = FIRST_ILLEGAL_CODE_POINT;
-        status = uni_prev(input.data, input.length, input.encoding, &input.index, &cp);
+        status = uni_prevchar(input.data, input.length, input.encoding, &input.index, &cp);
         if (status != UNI_OK)
         {
             assert(status == UNI_DONE); // LCOV_EXCL_BR_LINE
@@ -83,7 +83,7 @@ static unistat final_sigma_after(struct unitext input, bool *match)
     do
     {
         cp = FIRST_ILLEGAL_CODE_POINT;
-        status = uni_next(input.data, input.length, input.encoding, &input.index, &cp);
+        status = uni_nextchar(input.data, input.length, input.encoding, &input.index, &cp);
         if (status != UNI_OK)
         {
             if (status == UNI_DONE)
@@ -161,24 +161,6 @@ static unichar get_simple_mapping(unichar ch, unicaseconv type)
     return mapping;
 }
 
-static unihash uni_hash_char(unichar cp)
-{
-    unihash hash = (unihash)cp;
-    hash = ((hash >> UNIHASH_C(16)) ^ hash) * UNIHASH_C(0x45D9F3B);
-    hash = ((hash >> UNIHASH_C(16)) ^ hash) * UNIHASH_C(0x45D9F3B);
-    hash = (hash >> UNIHASH_C(16)) ^ hash;
-    return hash;
-}
-
-static unihash uni_xorshift(unihash x)
-{
-    unihash hash = x;
-    hash ^= hash << UNIHASH_C(13);
-    hash ^= hash >> UNIHASH_C(17);
-    hash ^= hash << UNIHASH_C(5);
-    return hash;
-}
-
 static const USpecialCasing *get_special_case_mapping_conditions(unichar codepoint)
 {
     const unihash hash = uni_hash_char(codepoint);
@@ -275,7 +257,7 @@ static unistat check_mapping(struct unitext before, struct unitext after, unicha
             const unichar *chars = get_special_case_mapping(special_casing, casing, &chars_count);
             for (unisize i = 0; (i < chars_count) && (*result == true); i++)
             {
-                status = uni_next(before.data, before.length, before.encoding, &before.index, &ch);
+                status = uni_nextchar(before.data, before.length, before.encoding, &before.index, &ch);
                 assert(status == UNI_OK); // LCOV_EXCL_BR_LINE
 
                 if (chars[i] != ch)
@@ -311,9 +293,16 @@ static unistat to_titlecase(const void *src, unisize src_len, uniattr src_attr,
 
     if (status == UNI_OK)
     {
-        unisize index = 0;
+        unisize index = uni_charbuf_resume(&buffer, NULL);
         while (status == UNI_OK)
         {
+            // Each word is title cased independently so output can resume from its start.
+            if (uni_charbuf_checkpoint(&buffer, index, 0))
+            {
+                status = UNI_DONE;
+                break;
+            }
+
             unisize next = index;
             status = uni_nextbrk(UNI_WORD, src, src_len, src_attr, &next);
             if (status == UNI_OK)
@@ -327,7 +316,7 @@ static unistat to_titlecase(const void *src, unisize src_len, uniattr src_attr,
                 {
                     unichar cp;
                     const struct unitext prev_text = {src, index, src_len, src_attr};
-                    (void)uni_next(src, src_len, src_attr, &index, &cp);
+                    (void)uni_nextchar(src, src_len, src_attr, &index, &cp);
                     const struct unitext next_text = {src, index, src_len, src_attr};
                     const uint8_t ccc = unicorn_get_codepoint_data(cp)->canonical_combining_class;
                     const bool cased = is_cased(cp);
@@ -384,7 +373,7 @@ static unistat is_titlecase(const void *src, unisize src_len, uniattr src_attr,
                 {
                     unichar cp;
                     const struct unitext prev_text = {src, index, src_len, src_attr};
-                    (void)uni_next(src, src_len, src_attr, &index, &cp);
+                    (void)uni_nextchar(src, src_len, src_attr, &index, &cp);
                     const struct unitext next_text = {src, index, src_len, src_attr};
                     const uint8_t ccc = unicorn_get_codepoint_data(cp)->canonical_combining_class;
                     const bool cased = is_cased(cp);
@@ -442,12 +431,19 @@ static unistat to_case(unicaseconv casing, const void *src, unisize src_len, uni
 
     if (status == UNI_OK)
     {
-        struct unitext text = {src, 0, src_len, src_attr};
+        struct unitext text = {src, uni_charbuf_resume(&buffer, NULL), src_len, src_attr};
         while (status == UNI_OK)
         {
+            // The casing context is read from the source text so output can resume from any character.
+            if (uni_charbuf_checkpoint(&buffer, text.index, 0))
+            {
+                status = UNI_DONE;
+                break;
+            }
+
             unichar cp;
             struct unitext prev_text = text;
-            status = uni_next(text.data, text.length, text.encoding, &text.index, &cp);
+            status = uni_nextchar(text.data, text.length, text.encoding, &text.index, &cp);
             if (status == UNI_OK)
             {
                 status = append_cased(&buffer, prev_text, text, cp, casing);
@@ -475,7 +471,7 @@ static unistat is_case(unicaseconv casing, const void *string, unisize length, u
         {
             unichar cp;
             struct unitext prev_text = text;
-            status = uni_next(text.data, text.length, text.encoding, &text.index, &cp);
+            status = uni_nextchar(text.data, text.length, text.encoding, &text.index, &cp);
             if (status == UNI_OK)
             {
                 status = check_mapping(prev_text, text, cp, casing, result);
@@ -26,6 +26,13 @@ struct CaseState
     int32_t offset;
     struct CharVec tmp;
     struct CharVec buf;
+
+    // Upper bound on the folded length of an unstable run or zero if runs are unbounded.
+    // Runs are bounded when the heap is disabled so they fit the stack buffers.
+    unisize limit;
+
+    // Workspace the buffers of nested normalization borrow from or null.
+    uniworkspace *workspace;
 };
 
 static unisize get_casefolding(unichar character, unichar casefolding[UNICORN_MAX_CASEFOLDING])
@@ -69,11 +76,21 @@ static bool is_canonical_caseless_stable(unichar ch)
     return is_stable;
 }
 
-static void init_casefold(struct CaseState *cs)
+static void init_casefold(struct CaseState *cs, uniworkspace *workspace)
 {
     (void)memset(cs, 0, sizeof(cs[0]));
-    uni_charvec_init(&cs->buf);
-    uni_charvec_init(&cs->tmp);
+    uni_charvec_init(&cs->buf, workspace);
+    uni_charvec_init(&cs->tmp, workspace);
+    cs->workspace = workspace;
+    if (uni_heap_disabled())
+    {
+        // Buffers borrowed from a workspace might have different capacities.
+        cs->limit = uni_charvec_capacity(&cs->buf) - UNISIZE_C(1);
+        if (cs->limit >= uni_charvec_capacity(&cs->tmp))
+        {
+            cs->limit = uni_charvec_capacity(&cs->tmp) - UNISIZE_C(1);
+        }
+    }
 }
 
 static void ucs_free(struct CaseState *cs)
@@ -109,7 +126,7 @@ static unistat collect_stable_run(struct CaseState *s, struct unitext *it)
 
     while (uni_charvec_length(&s->buf) < uni_charvec_capacity(&s->buf))
     {
-        status = uni_next(it->data, it->length, it->encoding, &index, &cp);
+        status = uni_nextchar(it->data, it->length, it->encoding, &index, &cp);
         const bool is_stable = is_canonical_caseless_stable(cp);
         if ((status == UNI_OK) && is_stable)
         {
@@ -130,7 +147,37 @@ static unistat collect_stable_run(struct CaseState *s, struct unitext *it)
     return status;
 }
 
-static unistat collect_unstable_run(struct unitext *it, unisize *span_length, bool *needs_normalization)
+// Returns the most characters the code point occupies in the buffers while it's normalized,
+// case folded, and normalized again.
+static unisize get_bounded_length(unichar cp)
+{
+    unichar decomp[LONGEST_UNICHAR_DECOMPOSITION];
+    unichar folded[UNICORN_MAX_CASEFOLDING];
+    unichar unused[LONGEST_UNICHAR_DECOMPOSITION];
+
+    // Runs that aren't normalized first are case folded directly.
+    unisize direct_length = 0;
+    const unisize folded_length = get_casefolding(cp, folded);
+    for (unisize i = 0; i < folded_length; i++)
+    {
+        direct_length += uni_norm_decompose(folded[i], unused);
+    }
+
+    unisize normalized_length = 0;
+    const unisize decomp_length = uni_norm_decompose(cp, decomp);
+    for (unisize i = 0; i < decomp_length; i++)
+    {
+        const unisize length = get_casefolding(decomp[i], folded);
+        for (unisize j = 0; j < length; j++)
+        {
+            normalized_length += uni_norm_decompose(folded[j], unused);
+        }
+    }
+
+    return (direct_length > normalized_length) ? direct_length : normalized_length;
+}
+
+static unistat collect_unstable_run(struct unitext *it, unisize limit, unisize *span_length, bool *needs_normalization)
 {
     // LCOV_EXCL_START
     assert(it != NULL);
@@ -142,11 +189,14 @@ static unistat collect_unstable_run(struct unitext *it, unisize *span_length, bo
 
     // Count the number of consecutive unstable code points.
     unistat status = UNI_OK;
+    unisize bounded_length = 0;
+    unisize boundary_index = it->index;
+    unisize boundary_length = 0;
     for (;;)
     {
         unichar cp = UNICHAR_C(0);
         unisize index = it->index;
-        status = uni_next(it->data, it->length, it->encoding, &index, &cp);
+        status = uni_nextchar(it->data, it->length, it->encoding, &index, &cp);
 
         const bool is_stable = is_canonical_caseless_stable(cp);
         if ((status != UNI_OK) || is_stable)
@@ -154,6 +204,34 @@ static unistat collect_unstable_run(struct unitext *it, unisize *span_length, bo
             break;
         }
 
+        if (limit > 0)
+        {
+            // Characters that are stable under NFD case fold to sequences that begin with a starter
+            // therefore the run can end before them without changing the result.
+            if (uni_is_stable_nfd(cp) && (*span_length > 0))
+            {
+                boundary_index = it->index;
+                boundary_length = *span_length;
+            }
+
+            // The run is cut short if it wouldn't fit the stack buffers.
+            bounded_length += get_bounded_length(cp);
+            if (bounded_length > limit)
+            {
+                if (boundary_length > 0)
+                {
+                    it->index = boundary_index;
+                    *span_length = boundary_length;
+                }
+                else
+                {
+                    uni_message("character sequence exceeds the stack buffer and heap allocation is disabled");
+                    status = UNI_TOO_LONG;
+                }
+                break;
+            }
+        }
+
         // The Unicode Standard requires that canonical decomposition (NFD normalization) be performed
         // before case folding when the string contains the character U+0345 (Combining Greek Ypogegrammeni)
         // or any character that has it as part of its canonical decomposition, such as U+1FC3 (Greek Small
@@ -176,7 +254,7 @@ static unistat collect_unstable_run(struct unitext *it, unisize *span_length, bo
 }
 
 // The caller has already vetted the text for well-formedness therefore this function assumes successful return codes.
-static unistat normalize_text(struct unitext *it, struct CharVec *text)
+static unistat normalize_text(struct unitext *it, struct CharVec *text, uniworkspace *workspace)
 {
     unistat status = UNI_OK;
     const unisize initial_index = it->index;
@@ -184,7 +262,7 @@ static unistat normalize_text(struct unitext *it, struct CharVec *text)
 
     // Compute the length of the stable run before allocating a buffer large enough for it.
     unisize length = 0;
-    uni_norm_init(&state, &uni_is_stable_nfd);
+    uni_norm_init(&state, &uni_is_stable_nfd, workspace);
     for (;;)
     {
         status = uni_norm_append_run(&state, it);
@@ -219,8 +297,10 @@ static unistat normalize_text(struct unitext *it, struct CharVec *text)
                 }
                 else
                 {
-                    assert(status == UNI_DONE); // LCOV_EXCL_BR_LINE
-                    status = UNI_OK;
+                    if (status == UNI_DONE)
+                    {
+                        status = UNI_OK;
+                    }
                     break;
                 }
             }
@@ -239,7 +319,7 @@ static unistat collect_run(struct CaseState *s, struct unitext *it)
     ucs_reset(s);
 
     // Retrieve the current code point.
-    status = uni_next(it->data, it->length, it->encoding, &it->index, &cp);
+    status = uni_nextchar(it->data, it->length, it->encoding, &it->index, &cp);
     it->index = startpos;
 
     if (status == UNI_OK)
@@ -255,14 +335,14 @@ static unistat collect_run(struct CaseState *s, struct unitext *it)
             // Count the number of consecutive unstable code points.
             unisize span_length = 0;
             bool needs_normalization = false;
-            status = collect_unstable_run(it, &span_length, &needs_normalization);
+            status = collect_unstable_run(it, s->limit, &span_length, &needs_normalization);
             if (status == UNI_OK)
             {
                 // Normalize the buffer if needed.
                 if (needs_normalization)
                 {
                     struct unitext tmp = {it->data, startpos, it->index, it->encoding};
-                    status = normalize_text(&tmp, &s->buf);
+                    status = normalize_text(&tmp, &s->buf, s->workspace);
                 }
                 else
                 {
@@ -275,7 +355,7 @@ static unistat collect_run(struct CaseState *s, struct unitext *it)
                         {
                             // There should be no errors since the unstable run was pre-calculated above;
                             // in other words only known-to-be-valid characters are iterated here.
-                            (void)uni_next(it->data, it->length, it->encoding, &it->index, &cp);
+                            (void)uni_nextchar(it->data, it->length, it->encoding, &it->index, &cp);
                             uni_charvec_append_unsafe(&s->buf, &cp, 1);
                         }
                     }
@@ -304,13 +384,13 @@ static unistat collect_run(struct CaseState *s, struct unitext *it)
 
                     // Normalize the text.
                     span_length = 0;
-                    status = uni_norm(UNI_NFD, s->tmp.chars, s->tmp.length, UNI_SCALAR | UNI_TRUST, NULL, &span_length, UNI_SCALAR);
+                    status = uni_normws(UNI_NFD, s->tmp.chars, s->tmp.length, UNI_SCALAR | UNI_TRUST, NULL, &span_length, UNI_SCALAR, s->workspace);
                     if (status == UNI_OK)
                     {
                         status = uni_charvec_reserve(&s->buf, span_length);
                         if (status == UNI_OK)
                         {
-                            status = uni_norm(UNI_NFD, s->tmp.chars, s->tmp.length, UNI_SCALAR | UNI_TRUST, s->buf.chars, &span_length, UNI_SCALAR);
+                            status = uni_normws(UNI_NFD, s->tmp.chars, s->tmp.length, UNI_SCALAR | UNI_TRUST, s->buf.chars, &span_length, UNI_SCALAR, s->workspace);
                             if (status == UNI_OK)
                             {
                                 s->buf.length = span_length;
@@ -338,11 +418,17 @@ static unistat to_casefold(const void *src, unisize src_len, uniattr src_attr, v
 
     if (status == UNI_OK)
     {
-        struct unitext input = {src, 0, src_len, src_attr};
+        struct unitext input = {src, uni_charbuf_resume(&buffer, NULL), src_len, src_attr};
         for (;;)
         {
+            if (uni_charbuf_checkpoint(&buffer, input.index, 0))
+            {
+                status = UNI_DONE;
+                break;
+            }
+
             unichar cp;
-            status = uni_next(input.data, input.length, input.encoding, &input.index, &cp);
+            status = uni_nextchar(input.data, input.length, input.encoding, &input.index, &cp);
             if (status != UNI_OK)
             {
                 break;
@@ -403,7 +489,7 @@ static unistat caseless_binary_compare(const void *s1, unisize s1_len, uniattr s
             {
                 run1.index = 0;
                 run1.length = 0;
-                status = uni_next(run1.it.data, run1.it.length, run1.it.encoding, &run1.it.index, &cp);
+                status = uni_nextchar(run1.it.data, run1.it.length, run1.it.encoding, &run1.it.index, &cp);
                 if (status == UNI_OK)
                 {
                     run1.length = get_casefolding(cp, run1.chars);
@@ -422,7 +508,7 @@ static unistat caseless_binary_compare(const void *s1, unisize s1_len, uniattr s
             {
                 run2.index = 0;
                 run2.length = 0;
-                status = uni_next(run2.it.data, run2.it.length, run2.it.encoding, &run2.it.index, &cp);
+                status = uni_nextchar(run2.it.data, run2.it.length, run2.it.encoding, &run2.it.index, &cp);
                 if (status == UNI_OK)
                 {
                     run2.length = get_casefolding(cp, run2.chars);
@@ -484,11 +570,18 @@ static unistat to_casefold_normalized(const void *src, unisize src_len, uniattr
 
     if (status == UNI_OK)
     {
-        struct unitext it = {src, 0, src_len, src_attr};
-        init_casefold(&cs);
+        struct unitext it = {src, uni_charbuf_resume(&buf, NULL), src_len, src_attr};
+        init_casefold(&cs, NULL);
 
         for (;;)
         {
+            // Each run is case folded independently so output can resume from its start.
+            if (uni_charbuf_checkpoint(&buf, it.index, 0))
+            {
+                status = UNI_DONE;
+                break;
+            }
+
             status = collect_run(&cs, &it);
             if ((ucs_length(&cs) == 0) || (status != UNI_OK))
             {
@@ -507,7 +600,7 @@ static unistat to_casefold_normalized(const void *src, unisize src_len, uniattr
     return status;
 }
 
-static unistat caseless_normalized_compare(const void *s1, unisize s1_len, uniattr s1_attr, const void *s2, unisize s2_len, uniattr s2_attr, bool *is_equal)
+static unistat caseless_normalized_compare(const void *s1, unisize s1_len, uniattr s1_attr, const void *s2, unisize s2_len, uniattr s2_attr, bool *is_equal, uniworkspace *workspace)
 {
     unistat status = UNI_OK;
     struct CaseState cs1 = {0};
@@ -533,8 +626,8 @@ static unistat caseless_normalized_compare(const void *s1, unisize s1_len, uniat
     {
         struct unitext it1 = {s1, 0, s1_len, s1_attr};
         struct unitext it2 = {s2, 0, s2_len, s2_attr};
-        init_casefold(&cs1);
-        init_casefold(&cs2);
+        init_casefold(&cs1, workspace);
+        init_casefold(&cs2, workspace);
 
         bool mismatch = false;
         while (!mismatch)
@@ -609,7 +702,7 @@ static unistat is_casefold(const void *text, unisize length, uniattr encoding, b
             // Don't update the iterator here; update it when comparing characters in the inner loop.
             unichar cp;
             unisize tmp = input.index;
-            status = uni_next(input.data, input.length, input.encoding, &tmp, &cp);
+            status = uni_nextchar(input.data, input.length, input.encoding, &tmp, &cp);
             if (status == UNI_OK)
             {
                 // Case fold the character and compare it against the input text.
@@ -617,7 +710,7 @@ static unistat is_casefold(const void *text, unisize length, uniattr encoding, b
                 const unisize chars_count = get_casefolding(cp, chars);
                 for (unisize i = 0; (i < chars_count); i++)
                 {
-                    status = uni_next(input.data, input.length, input.encoding, &input.index, &cp);
+                    status = uni_nextchar(input.data, input.length, input.encoding, &input.index, &cp);
 
                     // Decoding the character will always be successful because case folding always transforms
                     // one code point into one or more different code points and therefore if case folding
@@ -654,7 +747,7 @@ static unistat is_casefold_canonical(const void *text, unisize length, uniattr e
         struct unitext input = {text, 0, length, encoding};
         struct unitext prev;
 
-        init_casefold(&cs);
+        init_casefold(&cs, NULL);
         *result = true;
 
         while (*result)
@@ -669,7 +762,7 @@ static unistat is_casefold_canonical(const void *text, unisize length, uniattr e
             while (ucs_length(&cs) > 0)
             {
                 unichar cp;
-                status = uni_next(prev.data, prev.length, prev.encoding, &prev.index, &cp);
+                status = uni_nextchar(prev.data, prev.length, prev.encoding, &prev.index, &cp);
 
                 // Normalization can only ever expand the text and any malformed characters
                 // will have been decoded when collecting the normalization run therefore
@@ -727,7 +820,7 @@ UNICORN_API unistat uni_casefold(unicasefold casing, const void *src, unisize sr
     return status;
 }
 
-UNICORN_API unistat uni_casefoldcmp(unicasefold casing, const void *s1, unisize s1_len, uniattr s1_attr, const void *s2, unisize s2_len, uniattr s2_attr, bool *result) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+UNICORN_API unistat uni_casefoldcmpws(unicasefold casing, const void *s1, unisize s1_len, uniattr s1_attr, const void *s2, unisize s2_len, uniattr s2_attr, bool *result, uniworkspace *workspace) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
 {
     unistat status = UNI_OK;
 
@@ -742,7 +835,7 @@ UNICORN_API unistat uni_casefoldcmp(unicasefold casing, const void *s1, unisize
     else if (casing == UNI_CANONICAL)
     {
 #if defined(UNICORN_FEATURE_CASEFOLD_CANONICAL)
-        status = caseless_normalized_compare(s1, s1_len, s1_attr, s2, s2_len, s2_attr, result);
+        status = caseless_normalized_compare(s1, s1_len, s1_attr, s2, s2_len, s2_attr, result, workspace);
 #else
         status = UNI_FEATURE_DISABLED;
 #endif
@@ -756,6 +849,28 @@ UNICORN_API unistat uni_casefoldcmp(unicasefold casing, const void *s1, unisize
     return status;
 }
 
+UNICORN_API unistat uni_casefoldcmp(unicasefold casing, const void *s1, unisize s1_len, uniattr s1_attr, const void *s2, unisize s2_len, uniattr s2_attr, bool *result) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+{
+    return uni_casefoldcmpws(casing, s1, s1_len, s1_attr, s2, s2_len, s2_attr, result, NULL);
+}
+
+UNICORN_API unistat uni_viewcasefoldcmp(unicasefold casing, const uniview *v1, const uniview *v2, bool *result) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+{
+    unistat status;
+
+    if ((v1 == NULL) || (v2 == NULL))
+    {
+        uni_message("required argument is null");
+        status = UNI_BAD_OPERATION;
+    }
+    else
+    {
+        status = uni_casefoldcmp(casing, v1->text, v1->text_len, v1->text_attr, v2->text, v2->text_len, v2->text_attr, result);
+    }
+
+    return status;
+}
+
 UNICORN_API unistat uni_casefoldchk(unicasefold casing, const void *text, unisize text_len, uniattr text_attr, bool *result) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
 {
     unistat status = UNI_OK;
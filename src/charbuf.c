@@ -13,29 +13,87 @@
 
 #include "charbuf.h"
 #include "byteswap.h"
+#include "cpu.h"
 #include "unidata.h"
 
+// Returns how many characters fit in the remaining capacity of the storage for
+// encodings that encode every character as one code unit.
+static unisize fitting_units(const struct CharBuf *buf, unisize chars_count)
+{
+    unisize count = 0;
+    if ((buf->storage != NULL) && (buf->length < buf->capacity))
+    {
+        count = buf->capacity - buf->length;
+        if (count > chars_count)
+        {
+            count = chars_count;
+        }
+    }
+    return count;
+}
+
 #if defined(UNICORN_FEATURE_ENCODING_UTF8)
+// Returns the number of bytes the characters encode to in UTF-8.
+static unisize UTF8_length(const unichar *chars, unisize chars_count)
+{
+    unisize length = chars_count;
+    for (unisize i = 0; i < chars_count; i++)
+    {
+        const unichar ch = chars[i];
+        length += ((ch >= UNICHAR_C(0x80)) ? 1 : 0) + ((ch >= UNICHAR_C(0x800)) ? 1 : 0) + ((ch >= UNICHAR_C(0x10000)) ? 1 : 0);
+    }
+    return length;
+}
+
 static void uni_charbuf_append_u8(struct CharBuf *buf, const unichar *chars, unisize chars_count)
 {
     unichar8 *buffer = buf->storage; // cppcheck-suppress misra-c2012-11.5
-    if (buffer != NULL)
+    unisize i = 0;
+
+    if (buffer == NULL)
     {
-        buffer = &buffer[buf->length];
+        buf->length += UTF8_length(chars, chars_count);
+        i = chars_count;
     }
+    else
+    {
+        const struct Kernels *kernels = uni_kernels();
 
-    for (unisize i = 0; i < chars_count; i++)
+        // While there's room for the longest sequence characters are encoded directly into the
+        // storage without checking the capacity per character. Runs of ASCII are narrowed in bulk.
+        while ((i < chars_count) && ((buf->capacity - buf->length) >= 4))
+        {
+            unisize count;
+            if ((chars[i] < UNICHAR_C(0x80)) && ((chars_count - i) >= 16))
+            {
+                count = chars_count - i;
+                if (count > (buf->capacity - buf->length))
+                {
+                    count = buf->capacity - buf->length;
+                }
+                count = kernels->SCALAR_to_ASCII(&chars[i], count, &buffer[buf->length]);
+                i += count;
+            }
+            else
+            {
+                count = unichar_to_u8(chars[i], &buffer[buf->length]);
+                i += 1;
+            }
+            buf->length += count;
+            buf->written += count;
+        }
+    }
+
+    // Near the end of the storage each character is checked to see if it fits.
+    // Once a character doesn't fit, no subsequent characters are written.
+    for (; i < chars_count; i++)
     {
         unichar8 bytes[4];
         const unisize bytes_count = unichar_to_u8(chars[i], bytes);
-        if (buffer != NULL)
+        if ((buf->length + bytes_count) <= buf->capacity)
         {
-            if ((buf->length + bytes_count) <= buf->capacity)
-            {
-                (void)memcpy(buffer, bytes, (size_t)bytes_count);
-                buffer = &buffer[bytes_count];
-                buf->written += bytes_count;
-            }
+            (void)memcpy(&buffer[buf->length], bytes, (size_t)bytes_count);
+            buf->written += bytes_count;
         }
         buf->length += bytes_count;
     }
@@ -103,23 +161,56 @@ static unisize previous_UTF16_sequence_length(const unichar16 *words, ByteSwap16
 static void uni_charbuf_append_u16(struct CharBuf *buf, const unichar *chars, unisize chars_count, ByteSwap16 swap)
 {
     unichar16 *buffer = buf->storage; // cppcheck-suppress misra-c2012-11.5
-    if (buffer != NULL)
+    unisize i = 0;
+
+    if (buffer == NULL)
     {
-        buffer = &buffer[buf->length];
+        for (; i < chars_count; i++)
+        {
+            buf->length += (chars[i] >= UNICHAR_C(0x10000)) ? 2 : 1;
+        }
     }
+    else
+    {
+        const struct Kernels *kernels = uni_kernels();
+        const bool is_big = ((buf->encoding & UNI_BIG) == UNI_BIG) ? true : false;
 
-    for (unisize i = 0; i < chars_count; i++)
+        // While there's room for a surrogate pair characters are encoded directly into the storage
+        // without checking the capacity per character. Runs in the Basic Multilingual Plane are
+        // narrowed in bulk.
+        while ((i < chars_count) && ((buf->capacity - buf->length) >= 2))
+        {
+            unisize count;
+            if ((chars[i] <= UNICHAR_C(0xFFFF)) && ((chars_count - i) >= 8))
+            {
+                count = chars_count - i;
+                if (count > (buf->capacity - buf->length))
+                {
+                    count = buf->capacity - buf->length;
+                }
+                count = kernels->SCALAR_to_UTF16(&chars[i], count, &buffer[buf->length], is_big);
+                i += count;
+            }
+            else
+            {
+                count = unichar_to_u16(chars[i], &buffer[buf->length], swap);
+                i += 1;
+            }
+            buf->length += count;
+            buf->written += count;
+        }
+    }
+
+    // Near the end of the storage each character is checked to see if it fits.
+    // Once a character doesn't fit, no subsequent characters are written.
+    for (; i < chars_count; i++)
     {
         unichar16 words[2];
         const unisize words_count = unichar_to_u16(chars[i], words, swap);
-        if (buffer != NULL)
+        if ((buf->length + words_count) <= buf->capacity)
         {
-            if ((buf->length + words_count) <= buf->capacity)
-            {
-                (void)memcpy(buffer, words, sizeof(unichar16) * (size_t)words_count);
-                buffer = &buffer[words_count];
-                buf->written += words_count;
-            }
+            (void)memcpy(&buffer[buf->length], words, sizeof(unichar16) * (size_t)words_count);
+            buf->written += words_count;
         }
         buf->length += words_count;
     }
@@ -195,19 +286,13 @@ static void uni_charbuf_nullterminate_u16le(struct CharBuf *buf)
 static void uni_charbuf_append_u32(struct CharBuf *buf, const unichar *chars, unisize chars_count, ByteSwap32 swap)
 {
     unichar32 *buffer = buf->storage; // cppcheck-suppress misra-c2012-11.5
-    if (buffer != NULL)
-    {
-        buffer = &buffer[buf->length];
-    }
+    const unisize count = fitting_units(buf, chars_count);
 
-    for (unisize i = 0; i < chars_count; i++)
+    for (unisize i = 0; i < count; i++)
     {
-        if ((buffer != NULL) && (buf->length < buf->capacity))
-        {
-            buffer[i] = swap((unichar32)chars[i]);
-            buf->written += 1;
-        }
+        buffer[buf->length + i] = swap((unichar32)chars[i]);
     }
+    buf->written += count;
     buf->length += chars_count;
 }
 
@@ -264,22 +349,133 @@ static void uni_charbuf_nullterminate_u32(struct CharBuf *buf)
 }
 #endif
 
-static void uni_charbuf_append_scalar(struct CharBuf *buf, const unichar *chars, unisize chars_count)
+#if defined(UNICORN_FEATURE_ENCODING_LATIN1) || defined(UNICORN_FEATURE_ENCODING_CP1252)
+static void uni_charbuf_append_byte(struct CharBuf *buf, const unichar *chars, unisize chars_count, bool is_cp1252)
 {
-    unichar *buffer = buf->storage; // cppcheck-suppress misra-c2012-11.5
-    if (buffer != NULL)
+    unichar8 *buffer = buf->storage; // cppcheck-suppress misra-c2012-11.5
+    const struct Kernels *kernels = uni_kernels();
+
+    // Runs of characters that are identical in the encoding are narrowed in bulk. For
+    // Windows-1252 these are the ASCII characters because U+0080 through U+009F differ.
+    const unichar run_limit = is_cp1252 ? UNICHAR_C(0x80) : UNICHAR_C(0x100);
+    unisize i = 0;
+
+    while (i < chars_count)
     {
-        buffer = &buffer[buf->length];
+        unisize count = fitting_units(buf, chars_count - i);
+        if ((count >= 16) && (chars[i] < run_limit))
+        {
+            if (is_cp1252)
+            {
+                count = kernels->SCALAR_to_ASCII(&chars[i], count, &buffer[buf->length]);
+            }
+            else
+            {
+                count = kernels->SCALAR_to_LATIN1(&chars[i], count, &buffer[buf->length]);
+            }
+            buf->length += count;
+            buf->written += count;
+            i += count;
+        }
+        else
+        {
+            unichar8 byte = (unichar8)chars[i];
+            bool is_encodable = (chars[i] <= UNICHAR_C(0xFF)) ? true : false;
+#if defined(UNICORN_FEATURE_ENCODING_CP1252)
+            if (is_cp1252)
+            {
+                is_encodable = unichar_to_cp1252(chars[i], &byte);
+            }
+#endif
+
+            // Characters that cannot be encoded are still counted so the length
+            // of the output is consistent, but the conversion is reported as failed.
+            if (!is_encodable)
+            {
+                buf->has_unencodable = true;
+            }
+            else if ((buffer != NULL) && (buf->length < buf->capacity))
+            {
+                buffer[buf->length] = byte;
+                buf->written += 1;
+            }
+            else
+            {
+                // No Action.
+            }
+            buf->length += 1;
+            i += 1;
+        }
     }
+}
 
-    for (unisize i = 0; i < chars_count; i++)
+static void uni_charbuf_nullterminate_byte(struct CharBuf *buf)
+{
+    unichar8 *buffer = buf->storage; // cppcheck-suppress misra-c2012-11.5
+    if (buffer != NULL)
     {
-        if ((buffer != NULL) && (buf->length < buf->capacity))
+        bool needs_null = true;
+
+        // Check if the last character written is a null terminator. If it's not, then delete it
+        // and append the null terminator in its place. If there's room for the null terminator
+        // without deleting the last character, then do that instead.
+        if (buf->written > 0)
+        {
+            assert(buf->written <= buf->capacity); // LCOV_EXCL_BR_LINE
+            if (buffer[buf->written - 1] == (unichar8)0)
+            {
+                needs_null = false;
+            }
+            else
+            {
+                if (buf->written == buf->capacity)
+                {
+                    buf->written -= 1;
+                }
+            }
+        }
+
+        if (needs_null)
         {
-            buffer[i] = chars[i];
-            buf->written += 1;
+            if (buf->written < buf->capacity)
+            {
+                buffer[buf->written] = (unichar8)0;
+                buf->written += 1;
+            }
         }
     }
+
+    if (!buf->is_null_terminated)
+    {
+        buf->length += 1;
+    }
+}
+#endif
+
+#if defined(UNICORN_FEATURE_ENCODING_LATIN1)
+static void uni_charbuf_append_latin1(struct CharBuf *buf, const unichar *chars, unisize chars_count)
+{
+    uni_charbuf_append_byte(buf, chars, chars_count, false);
+}
+#endif
+
+#if defined(UNICORN_FEATURE_ENCODING_CP1252)
+static void uni_charbuf_append_cp1252(struct CharBuf *buf, const unichar *chars, unisize chars_count)
+{
+    uni_charbuf_append_byte(buf, chars, chars_count, true);
+}
+#endif
+
+static void uni_charbuf_append_scalar(struct CharBuf *buf, const unichar *chars, unisize chars_count)
+{
+    unichar *buffer = buf->storage; // cppcheck-suppress misra-c2012-11.5
+    const unisize count = fitting_units(buf, chars_count);
+
+    if (count > 0)
+    {
+        (void)memcpy(&buffer[buf->length], chars, sizeof(unichar) * (size_t)count);
+    }
+    buf->written += count;
     buf->length += chars_count;
 }
 
@@ -325,6 +521,250 @@ static void uni_charbuf_nullterminate_scalar(struct CharBuf *buf)
     }
 }
 
+// Returns the maximum number of code units a single character encodes to.
+static unisize max_code_units(uniattr attributes)
+{
+    unisize units;
+    switch (GET_ENCODING(attributes))
+    {
+    case UNI_UTF8:
+        units = 4;
+        break;
+    case UNI_UTF16:
+        units = 2;
+        break;
+    default:
+        units = 1;
+        break;
+    }
+    return units;
+}
+
+// Returns the size in bytes of a code unit.
+static size_t code_unit_size(uniattr attributes)
+{
+    size_t size;
+    switch (GET_ENCODING(attributes))
+    {
+    case UNI_UTF16:
+        size = sizeof(unichar16);
+        break;
+    case UNI_UTF32:
+    case UNI_SCALAR:
+        size = sizeof(unichar32);
+        break;
+    default:
+        size = sizeof(unichar8);
+        break;
+    }
+    return size;
+}
+
+// Delivers the code units written to the storage to the sink and empties the storage.
+// Once the sink reports an error nothing more is delivered to it.
+static void uni_charbuf_flush(struct CharBuf *buf)
+{
+    if ((buf->status == UNI_OK) && (buf->written > 0))
+    {
+        buf->status = buf->sink->write(buf->sink->user_data, buf->storage, buf->written);
+        if (buf->status == UNI_OK)
+        {
+            buf->flushed += buf->written;
+        }
+    }
+    buf->length = 0;
+    buf->written = 0;
+}
+
+// Geometrically grows the allocated storage so it has room for 'units' more code units.
+// The allocation is kept in sync with the caller's buffer so it can always be freed.
+// If the allocation fails, then the characters written so far are discarded.
+static void uni_charbuf_grow(struct CharBuf *buf, unisize units)
+{
+    const size_t unit_size = code_unit_size(buf->encoding);
+
+    if (units > (INT32_MAX - buf->length))
+    {
+        uni_message("output buffer length overflow"); // LCOV_EXCL_LINE
+        buf->status = UNI_NO_MEMORY; // LCOV_EXCL_LINE
+    }
+
+    if (buf->status == UNI_OK)
+    {
+        unisize capacity = (buf->capacity < (INT32_MAX / 2)) ? (buf->capacity * 2) : INT32_MAX;
+        if (capacity < (buf->length + units))
+        {
+            capacity = buf->length + units;
+        }
+
+        void *storage = uni_realloc(buf->alloc->data, buf->alloc->size, (size_t)capacity * unit_size);
+        if (storage == NULL)
+        {
+            uni_message("failed to grow the output buffer");
+            buf->status = UNI_NO_MEMORY;
+        }
+        else
+        {
+            buf->alloc->data = storage;
+            buf->alloc->size = (size_t)capacity * unit_size;
+            buf->storage = storage;
+            buf->capacity = capacity;
+        }
+    }
+
+    if (buf->status != UNI_OK)
+    {
+        buf->length = 0;
+        buf->written = 0;
+    }
+}
+
+// Releases the unused capacity of the allocated storage.
+static void uni_charbuf_shrink(struct CharBuf *buf)
+{
+    const size_t size = (size_t)buf->written * code_unit_size(buf->encoding);
+    if ((buf->status == UNI_OK) && (size > (size_t)0) && (size < buf->alloc->size))
+    {
+        void *storage = uni_realloc(buf->alloc->data, buf->alloc->size, size);
+        if (storage != NULL)
+        {
+            buf->alloc->data = storage;
+            buf->alloc->size = size;
+            buf->storage = storage;
+            buf->capacity = buf->written;
+        }
+        else
+        {
+            // No Action. Failing to shrink leaves the larger buffer intact.
+        }
+    }
+}
+
+// Appends characters to storage that is either flushed to a sink or grown when it's full.
+static void uni_charbuf_append_staged(struct CharBuf *buf, const unichar *chars, unisize chars_count)
+{
+    const unisize max_units = max_code_units(buf->encoding);
+    unisize i = 0;
+
+    while (i < chars_count)
+    {
+        uni_charbuf_reserve(buf, max_units);
+        if (buf->status != UNI_OK)
+        {
+            break;
+        }
+
+        // Encode as many characters as are guaranteed to fit in the storage.
+        unisize count = (buf->capacity - buf->length) / max_units;
+        if (count > (chars_count - i))
+        {
+            count = chars_count - i;
+        }
+        buf->encoder->append(buf, &chars[i], count);
+        i += count;
+    }
+}
+
+static void uni_charbuf_nullterminate_staged(struct CharBuf *buf)
+{
+    if (!buf->is_null_terminated)
+    {
+        const unichar null_char = UNICHAR_C(0);
+        uni_charbuf_append_staged(buf, &null_char, 1);
+    }
+}
+
+// Returns the number of code units the character encodes to.
+static unisize encoded_units(uniattr attributes, unichar ch)
+{
+    unisize units = 1;
+    switch (GET_ENCODING(attributes))
+    {
+    case UNI_UTF8:
+        if (ch >= UNICHAR_C(0x10000))
+        {
+            units = 4;
+        }
+        else if (ch >= UNICHAR_C(0x800))
+        {
+            units = 3;
+        }
+        else if (ch >= UNICHAR_C(0x80))
+        {
+            units = 2;
+        }
+        else
+        {
+            // No Action.
+        }
+        break;
+    case UNI_UTF16:
+        if (ch >= UNICHAR_C(0x10000))
+        {
+            units = 2;
+        }
+        break;
+    default:
+        // All other encodings use one code unit per character.
+        break;
+    }
+    return units;
+}
+
+// Appends characters to the storage of a cursor. The characters emitted by a previous call
+// are regenerated by the caller and skipped rather than written. Once a character doesn't
+// fit the storage is full and nothing more is written.
+static void uni_charbuf_append_cursor(struct CharBuf *buf, const unichar *chars, unisize chars_count)
+{
+    const unisize max_units = max_code_units(buf->encoding);
+    unisize i = 0;
+
+    while ((i < chars_count) && (buf->status == UNI_OK))
+    {
+        if (buf->skip > 0)
+        {
+            const unisize units = encoded_units(buf->encoding, chars[i]);
+            buf->skip -= units;
+            buf->since_checkpoint += units;
+            i += 1;
+        }
+        else
+        {
+            // Encode as many characters as are guaranteed to fit in the storage.
+            // Near the end of the storage characters are encoded one at a time.
+            unisize count = (buf->capacity - buf->length) / max_units;
+            if (count == 0)
+            {
+                count = 1;
+            }
+
+            if (count > (chars_count - i))
+            {
+                count = chars_count - i;
+            }
+
+            const unisize written = buf->written;
+            buf->encoder->append(buf, &chars[i], count);
+            if (buf->length > buf->capacity)
+            {
+                buf->length = buf->written;
+                buf->status = UNI_NO_SPACE;
+            }
+            buf->since_checkpoint += buf->written - written;
+            i += count;
+        }
+    }
+}
+
+static void uni_charbuf_nullterminate_cursor(struct CharBuf *buf)
+{
+    if (!buf->is_null_terminated)
+    {
+        const unichar null_char = UNICHAR_C(0);
+        uni_charbuf_append_cursor(buf, &null_char, 1);
+    }
+}
+
 unistat uni_charbuf_init(struct CharBuf *buf, void *text, unisize *capacity, uniattr attributes)
 {
 #if defined(UNICORN_FEATURE_ENCODING_UTF8)
@@ -358,21 +798,57 @@ unistat uni_charbuf_init(struct CharBuf *buf, void *text, unisize *capacity, uni
     };
 #endif
 
+#if defined(UNICORN_FEATURE_ENCODING_LATIN1)
+    static const struct CharBufImpl uni_charbuf_latin1 = {
+        .append = &uni_charbuf_append_latin1,
+        .nullterminate = &uni_charbuf_nullterminate_byte,
+    };
+#endif
+
+#if defined(UNICORN_FEATURE_ENCODING_CP1252)
+    static const struct CharBufImpl uni_charbuf_cp1252 = {
+        .append = &uni_charbuf_append_cp1252,
+        .nullterminate = &uni_charbuf_nullterminate_byte,
+    };
+#endif
+
     static const struct CharBufImpl uni_charbuf_scalar = {
         .append = &uni_charbuf_append_scalar,
         .nullterminate = &uni_charbuf_nullterminate_scalar,
     };
 
+    static const struct CharBufImpl uni_charbuf_staged = {
+        .append = &uni_charbuf_append_staged,
+        .nullterminate = &uni_charbuf_nullterminate_staged,
+    };
+
+    static const struct CharBufImpl uni_charbuf_cursor = {
+        .append = &uni_charbuf_append_cursor,
+        .nullterminate = &uni_charbuf_nullterminate_cursor,
+    };
+
     unistat status = uni_check_output_encoding(text, capacity, &attributes);
     if (status == UNI_OK)
     {
         buf->storage = text;
-        buf->capacity = *capacity;
+        buf->capacity = 0;
         buf->length = 0;
         buf->written = 0;
         buf->result = capacity;
+        buf->encoding = attributes;
         buf->null_terminate = ((attributes & UNI_NULIFY) == UNI_NULIFY) ? true : false;
         buf->is_null_terminated = false;
+        buf->has_unencodable = false;
+        buf->sink = NULL;
+        buf->alloc = NULL;
+        buf->cursor = NULL;
+        buf->encoder = NULL;
+        buf->flushed = 0;
+        buf->skip = 0;
+        buf->checkpoint = 0;
+        buf->checkpoint_state = 0;
+        buf->since_checkpoint = 0;
+        buf->status = UNI_OK;
 
         switch (GET_ENCODING(attributes)) // LCOV_EXCL_BR_LINE
         {
@@ -408,6 +884,18 @@ unistat uni_charbuf_init(struct CharBuf *buf, void *text, unisize *capacity, uni
             break;
 #endif
 
+#if defined(UNICORN_FEATURE_ENCODING_LATIN1)
+        case UNI_LATIN1:
+            buf->impl = &uni_charbuf_latin1;
+            break;
+#endif
+
+#if defined(UNICORN_FEATURE_ENCODING_CP1252)
+        case UNI_CP1252:
+            buf->impl = &uni_charbuf_cp1252;
+            break;
+#endif
+
         case UNI_SCALAR:
             buf->impl = &uni_charbuf_scalar;
             break;
@@ -420,6 +908,101 @@ unistat uni_charbuf_init(struct CharBuf *buf, void *text, unisize *capacity, uni
         }
     }
 
+    if (status == UNI_OK)
+    {
+        if ((attributes & UNI_SINK) == UNI_SINK)
+        {
+            // The characters are staged in the buffer of the sink and flushed when it's full.
+            unisink *sink = text; // cppcheck-suppress misra-c2012-11.5
+            if ((sink->write == NULL) || (sink->buffer == NULL))
+            {
+                uni_message("sink callback or buffer is null");
+                status = UNI_BAD_OPERATION;
+            }
+            else if (sink->buffer_len < max_code_units(attributes))
+            {
+                uni_message("sink buffer is too small to hold a character");
+                status = UNI_BAD_OPERATION;
+            }
+            else
+            {
+                buf->sink = sink;
+                buf->storage = sink->buffer;
+                buf->capacity = sink->buffer_len;
+                buf->encoder = buf->impl;
+                buf->impl = &uni_charbuf_staged;
+            }
+        }
+        else if ((attributes & UNI_CURSOR) == UNI_CURSOR)
+        {
+            // The characters are written to the buffer of the cursor until it's full. The
+            // output resumes from the last checkpoint recorded by the previous call.
+            unicursor *cursor = text; // cppcheck-suppress misra-c2012-11.5
+            if (cursor->buffer == NULL)
+            {
+                uni_message("cursor buffer is null");
+                status = UNI_BAD_OPERATION;
+            }
+            else if (cursor->buffer_len < max_code_units(attributes))
+            {
+                uni_message("cursor buffer is too small to hold a character");
+                status = UNI_BAD_OPERATION;
+            }
+            else if ((cursor->index < 0) || (cursor->skip < 0))
+            {
+                uni_message("cursor is corrupt");
+                status = UNI_BAD_OPERATION;
+            }
+            else
+            {
+                buf->cursor = cursor;
+                buf->storage = cursor->buffer;
+                buf->capacity = cursor->buffer_len;
+                buf->skip = cursor->skip;
+                buf->checkpoint = cursor->index;
+                buf->checkpoint_state = cursor->state;
+                buf->encoder = buf->impl;
+                buf->impl = &uni_charbuf_cursor;
+            }
+        }
+        else if ((attributes & UNI_ALLOC) == UNI_ALLOC)
+        {
+            // The characters are written to the caller's allocation which grows when it's full.
+            // An existing allocation is reused otherwise an initial allocation is made so the
+            // storage is never null.
+            unibuf *alloc = text; // cppcheck-suppress misra-c2012-11.5
+            const size_t unit_size = code_unit_size(attributes);
+            if ((alloc->data == NULL) || (alloc->size < unit_size))
+            {
+                const size_t size = (size_t)64 * unit_size; // Arbitrary initial capacity; it grows geometrically.
+                void *storage = uni_realloc(alloc->data, alloc->size, size);
+                if (storage == NULL)
+                {
+                    uni_message("failed to allocate the output buffer");
+                    status = UNI_NO_MEMORY;
+                }
+                else
+                {
+                    alloc->data = storage;
+                    alloc->size = size;
+                }
+            }
+
+            if (status == UNI_OK)
+            {
+                buf->alloc = alloc;
+                buf->storage = alloc->data;
+                buf->capacity = (unisize)(alloc->size / unit_size);
+                buf->encoder = buf->impl;
+                buf->impl = &uni_charbuf_staged;
+            }
+        }
+        else
+        {
+            buf->capacity = *capacity;
+        }
+    }
+
     return status;
 }
 
@@ -432,7 +1015,41 @@ unistat uni_charbuf_finalize(struct CharBuf *buf)
         buf->impl->nullterminate(buf);
     }
 
-    if (buf->storage != NULL)
+    if (buf->sink != NULL)
+    {
+        uni_charbuf_flush(buf);
+        *buf->result = buf->flushed;
+        status = buf->status;
+    }
+    else if (buf->cursor != NULL)
+    {
+        // Record where the output stopped so the next call continues from there.
+        // Once the output is complete the cursor is reset so it can be reused.
+        if (buf->status == UNI_NO_SPACE)
+        {
+            buf->cursor->index = buf->checkpoint;
+            buf->cursor->skip = buf->since_checkpoint;
+            buf->cursor->state = buf->checkpoint_state;
+        }
+        else
+        {
+            buf->cursor->index = 0;
+            buf->cursor->skip = 0;
+            buf->cursor->state = 0;
+        }
+        *buf->result = buf->written;
+        status = buf->status;
+    }
+    else if (buf->alloc != NULL)
+    {
+        if ((buf->encoding & UNI_SHRINK) == UNI_SHRINK)
+        {
+            uni_charbuf_shrink(buf);
+        }
+        *buf->result = buf->written;
+        status = buf->status;
+    }
+    else if (buf->storage != NULL)
     {
         if (buf->length > buf->capacity)
         {
@@ -445,6 +1062,12 @@ unistat uni_charbuf_finalize(struct CharBuf *buf)
         *buf->result = buf->length;
     }
 
+    if (buf->has_unencodable)
+    {
+        uni_message("character cannot be encoded in the output encoding");
+        status = UNI_BAD_ENCODING;
+    }
+
     return status;
 }
 
@@ -471,3 +1094,54 @@ void uni_charbuf_appendchar(struct CharBuf *buf, unichar ch)
 {
     uni_charbuf_append(buf, &ch, 1);
 }
+
+void uni_charbuf_reserve(struct CharBuf *buf, unisize units)
+{
+    if ((buf->capacity - buf->length) < units)
+    {
+        if (buf->sink != NULL)
+        {
+            uni_charbuf_flush(buf);
+        }
+        else if (buf->alloc != NULL)
+        {
+            uni_charbuf_grow(buf, units);
+        }
+        else
+        {
+            // No Action.
+        }
+    }
+}
+
+unisize uni_charbuf_resume(const struct CharBuf *buf, int32_t *state)
+{
+    unisize index = 0;
+    if (state != NULL)
+    {
+        *state = 0;
+    }
+
+    if (buf->cursor != NULL)
+    {
+        index = buf->checkpoint;
+        if (state != NULL)
+        {
+            *state = buf->checkpoint_state;
+        }
+    }
+
+    return index;
+}
+
+bool uni_charbuf_checkpoint(struct CharBuf *buf, unisize index, int32_t state)
+{
+    if ((buf->cursor != NULL) && (buf->status == UNI_OK) && (buf->skip == 0))
+    {
+        buf->checkpoint = index;
+        buf->checkpoint_state = state;
+        buf->since_checkpoint = 0;
+    }
+
+    return buf->status != UNI_OK;
+}
@@ -32,9 +32,42 @@ struct CharBuf
 
     unisize capacity;
     unisize *result;
+
+    // Encoding form and byte order of the storage.
+    uniattr encoding;
     bool null_terminate;
     bool is_null_terminated;
+
+    // Set when a character has no representation in the encoding of the storage.
+    bool has_unencodable;
     const struct CharBufImpl *impl;
+
+    // The sink the storage is flushed to or null if the storage is the destination.
+    // For sinks the storage is a staging buffer that is reused after each flush, the
+    // characters are encoded by the 'encoder', and 'flushed' counts the code units
+    // delivered to the sink.
+    unisink *sink;
+
+    // The caller's allocation or null if the storage isn't allocated by the library.
+    // The storage is the allocation and grows geometrically when it's full.
+    unibuf *alloc;
+
+    // The cursor the output resumes from or null if the output isn't resumable.
+    // The characters from the 'checkpoint' in the source text are regenerated and
+    // the first 'skip' code units are discarded because the previous call already
+    // emitted them. The 'since_checkpoint' member counts the code units emitted,
+    // or skipped, since the last checkpoint.
+    unicursor *cursor;
+    unisize skip;
+    unisize checkpoint;
+    int32_t checkpoint_state;
+    unisize since_checkpoint;
+
+    const struct CharBufImpl *encoder;
+    unisize flushed;
+
+    // Status of delivering characters to the sink, growing the allocation, or filling the cursor.
+    unistat status;
 };
 
 struct CharBufImpl
@@ -49,4 +82,23 @@ unistat uni_charbuf_finalize(struct CharBuf *buf);
 void uni_charbuf_append(struct CharBuf *buf, const unichar *chars, unisize chars_count);
 void uni_charbuf_appendchar(struct CharBuf *buf, unichar ch);
 
+// Appends the characters between the code unit offsets 'start' and 'end' of the text which must
+// have been decoded successfully beforehand. Code units are copied in bulk when the encoding form
+// of the text matches the buffer. This must not be used with resumable output.
+void uni_charbuf_append_text(struct CharBuf *buf, const void *text, unisize start, unisize end, uniattr text_attr);
+
+// Ensures the storage has room for 'units' more code units by flushing it to the sink
+// or growing the allocation, if there is one. Fixed size storage is left as is.
+void uni_charbuf_reserve(struct CharBuf *buf, unisize units);
+
+// Returns the source index the output resumes from. This is zero unless the buffer
+// is a cursor. The algorithm specific state recorded at that index is written to 'state'.
+unisize uni_charbuf_resume(const struct CharBuf *buf, int32_t *state);
+
+// Records the source index, and algorithm specific state, of a position the output can
+// resume from. Algorithms must only record positions where their state can be restored
+// from 'index' and 'state' alone. Returns true if the output stopped, in which case the
+// algorithm should stop processing the source text and finalize the buffer.
+bool uni_charbuf_checkpoint(struct CharBuf *buf, unisize index, int32_t state);
+
 #endif // CHARBUF_H
@@ -13,6 +13,58 @@
 
 #include "charvec.h"
 
+// Storage borrowed from a workspace outlives the call that grew it, therefore it's allocated
+// with the process-wide allocator, like the workspace itself, rather than the allocator of
+// the context which might be an arena that's reset between calls.
+static void *allocate(const struct CharVec *buffer, size_t size)
+{
+    void *ptr;
+    if (buffer->slot != NULL)
+    {
+        ptr = uni_global_malloc(size);
+    }
+    else
+    {
+        ptr = uni_malloc(size);
+    }
+    return ptr;
+}
+
+static void *reallocate(const struct CharVec *buffer, size_t old_size, size_t new_size)
+{
+    void *ptr;
+    if (buffer->slot != NULL)
+    {
+        ptr = uni_global_realloc(buffer->chars, old_size, new_size);
+    }
+    else
+    {
+        ptr = uni_realloc(buffer->chars, old_size, new_size);
+    }
+    return ptr;
+}
+
+// Returns the first slot of the workspace that isn't borrowed. Callers initialize and free
+// their vectors in the same order on every call, so they borrow the same slots every time
+// and each slot settles at the capacity its vector needs.
+static struct WorkspaceSlot *borrow_slot(uniworkspace *workspace)
+{
+    struct WorkspaceSlot *slot = NULL;
+    if (workspace != NULL)
+    {
+        for (size_t i = 0; i < COUNT_OF(workspace->slots); i++)
+        {
+            if (!workspace->slots[i].in_use)
+            {
+                slot = &workspace->slots[i];
+                slot->in_use = true;
+                break;
+            }
+        }
+    }
+    return slot;
+}
+
 unistat uni_charvec_reserve(struct CharVec *buffer, unisize new_capacity)
 {
     unistat status = UNI_OK;
@@ -22,12 +74,18 @@ unistat uni_charvec_reserve(struct CharVec *buffer, unisize new_capacity)
     assert(new_capacity >= 0);
     // LCOV_EXCL_STOP
 
-    if (new_capacity > buffer->capacity)
+    if ((new_capacity > buffer->capacity) && uni_heap_disabled())
+    {
+        // The stack buffer can't grow without heap allocation.
+        uni_message("character sequence exceeds the stack buffer and heap allocation is disabled");
+        status = UNI_TOO_LONG;
+    }
+    else if (new_capacity > buffer->capacity)
     {
         unichar *ptr;
         if (buffer->chars == buffer->scratch)
         {
-            ptr = uni_malloc(sizeof(buffer->chars[0]) * (size_t)new_capacity); // cppcheck-suppress misra-c2012-11.5 ; MISRA 2012 Rule 11.5 - Pointer conversion required.
+            ptr = allocate(buffer, sizeof(buffer->chars[0]) * (size_t)new_capacity); // cppcheck-suppress misra-c2012-11.5 ; MISRA 2012 Rule 11.5 - Pointer conversion required.
             if (ptr != NULL)
             {
                 (void)memcpy(ptr, buffer->scratch, sizeof(buffer->chars[0]) * (size_t)buffer->capacity);
@@ -35,9 +93,9 @@ unistat uni_charvec_reserve(struct CharVec *buffer, unisize new_capacity)
         }
         else
         {
-            ptr = uni_realloc(buffer->chars, // cppcheck-suppress misra-c2012-11.5 ; MISRA 2012 Rule 11.5 - Pointer conversion required.
-                              sizeof(buffer->chars[0]) * (size_t)buffer->capacity,
-                              sizeof(buffer->chars[0]) * (size_t)new_capacity);
+            ptr = reallocate(buffer, // cppcheck-suppress misra-c2012-11.5 ; MISRA 2012 Rule 11.5 - Pointer conversion required.
+                             sizeof(buffer->chars[0]) * (size_t)buffer->capacity,
+                             sizeof(buffer->chars[0]) * (size_t)new_capacity);
         }
 
         if (ptr == NULL)
@@ -55,6 +113,22 @@ unistat uni_charvec_reserve(struct CharVec *buffer, unisize new_capacity)
     return status;
 }
 
+// Grows the buffer geometrically so repeatedly appending to it takes amortized constant time.
+unistat uni_charvec_grow(struct CharVec *buffer, unisize min_capacity)
+{
+    unistat status = UNI_OK;
+    if (min_capacity > buffer->capacity)
+    {
+        unisize new_capacity = buffer->capacity * UNISIZE_C(2);
+        if (new_capacity < min_capacity)
+        {
+            new_capacity = min_capacity;
+        }
+        status = uni_charvec_reserve(buffer, new_capacity);
+    }
+    return status;
+}
+
 unistat uni_charvec_append(struct CharVec *buffer, const unichar *chars, unisize chars_count)
 {
     // LCOV_EXCL_START
@@ -84,20 +158,43 @@ void uni_charvec_reset(struct CharVec *buffer)
     buffer->length = 0;
 }
 
-void uni_charvec_init(struct CharVec *buffer)
+void uni_charvec_init(struct CharVec *buffer, uniworkspace *workspace)
 {
     const size_t scratch_buffer_size = COUNT_OF(buffer->scratch);
     buffer->length = 0;
     buffer->capacity = (unisize)scratch_buffer_size;
     buffer->chars = buffer->scratch;
+    buffer->slot = borrow_slot(workspace);
+
+    // Adopt the storage retained by the slot, if it has any, so the vector
+    // starts with the capacity it grew to on previous calls.
+    if ((buffer->slot != NULL) && (buffer->slot->chars != NULL))
+    {
+        buffer->chars = buffer->slot->chars;
+        buffer->capacity = buffer->slot->capacity;
+    }
 }
 
 void uni_charvec_free(struct CharVec *buffer)
 {
-    if (buffer->chars != buffer->scratch)
+    if (buffer->slot != NULL)
+    {
+        // Return the storage to the workspace instead of releasing it.
+        if (buffer->chars != buffer->scratch)
+        {
+            buffer->slot->chars = buffer->chars;
+            buffer->slot->capacity = buffer->capacity;
+        }
+        buffer->slot->in_use = false;
+    }
+    else if (buffer->chars != buffer->scratch)
     {
         uni_free(buffer->chars, sizeof(buffer->chars[0]) * (size_t)buffer->capacity);
     }
+    else
+    {
+        // No Action.
+    }
 }
 
 void uni_charvec_remove(struct CharVec *buf, unisize i)
@@ -18,19 +18,39 @@
 
 #include "common.h"
 
+// Maximum number of character vectors that can borrow storage from a workspace at once.
+// The deepest user is canonical caseless comparison which has six live vectors.
+#define WORKSPACE_SLOT_COUNT 8
+
+// Heap storage retained by a workspace between calls. While a character vector
+// borrows the slot, the vector owns the storage and returns it when it's freed.
+struct WorkspaceSlot
+{
+    unichar *chars;
+    unisize capacity;
+    bool in_use;
+};
+
+struct uniworkspace
+{
+    struct WorkspaceSlot slots[WORKSPACE_SLOT_COUNT];
+};
+
 struct CharVec
 {
     unisize length;
     unisize capacity;
     unichar *chars;
+    struct WorkspaceSlot *slot;
     unichar scratch[UNICORN_STACK_BUFFER_SIZE];
 };
 
-void uni_charvec_init(struct CharVec *buffer);
+void uni_charvec_init(struct CharVec *buffer, uniworkspace *workspace);
 void uni_charvec_free(struct CharVec *buffer);
 void uni_charvec_reset(struct CharVec *buffer);
 unistat uni_charvec_append(struct CharVec *buffer, const unichar *chars, unisize chars_count);
 unistat uni_charvec_reserve(struct CharVec *buffer, unisize new_capacity);
+unistat uni_charvec_grow(struct CharVec *buffer, unisize min_capacity);
 void uni_charvec_remove(struct CharVec *buf, unisize i);
 void uni_charvec_append_unsafe(struct CharVec *cb, const unichar *chars, unisize chars_count);
 
@@ -39,9 +39,9 @@ struct SortKey
     uint16_t weights[(UNICORN_MAX_COLLATION * 3) + 3];
 };
 
-static void sortkeybuf_init(struct SortKey *state, uniweighting weighting, unistrength strength)
+static void sortkeybuf_init(struct SortKey *state, uniweighting weighting, unistrength strength, uniworkspace *workspace)
 {
-    uni_cebuf_init(&state->ce_decoder);
+    uni_cebuf_init(&state->ce_decoder, workspace);
     state->weights_index = 0;
     state->weights_count = 0;
     state->is_prev_variable = false;
@@ -215,12 +215,12 @@ static unistat sortkeybuf_append_run(struct SortKey *state, struct unitext *text
 
 #endif
 
-UNICORN_API unistat uni_sortkeymk(const void *text, unisize text_len, uniattr text_attr, uniweighting weighting, unistrength strength, uint16_t *sortkey, size_t *sortkey_cap) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+UNICORN_API unistat uni_sortkeymkws(const void *text, unisize text_len, uniattr text_attr, uniweighting weighting, unistrength strength, uint16_t *sortkey, size_t *sortkey_cap, uniworkspace *workspace) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
 {
 #if defined(UNICORN_FEATURE_COLLATION)
     unistat status = UNI_OK;
     struct SortKey skbuf = {0};
-    sortkeybuf_init(&skbuf, weighting, strength);
+    sortkeybuf_init(&skbuf, weighting, strength, workspace);
 
     // Do the null check here to simplify the 'else' body below.
     if (sortkey_cap == NULL)
@@ -293,7 +293,12 @@ UNICORN_API unistat uni_sortkeymk(const void *text, unisize text_len, uniattr te
 #endif
 }
 
-UNICORN_API unistat uni_collate(const void *s1, unisize s1_len, uniattr s1_attr, const void *s2, unisize s2_len, uniattr s2_attr, uniweighting weighting, unistrength strength, int32_t *result) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+UNICORN_API unistat uni_sortkeymk(const void *text, unisize text_len, uniattr text_attr, uniweighting weighting, unistrength strength, uint16_t *sortkey, size_t *sortkey_cap) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+{
+    return uni_sortkeymkws(text, text_len, text_attr, weighting, strength, sortkey, sortkey_cap, NULL);
+}
+
+UNICORN_API unistat uni_collatews(const void *s1, unisize s1_len, uniattr s1_attr, const void *s2, unisize s2_len, uniattr s2_attr, uniweighting weighting, unistrength strength, int32_t *result, uniworkspace *workspace) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
 {
 #if defined(UNICORN_FEATURE_COLLATION)
     unistat status = UNI_OK;
@@ -301,8 +306,8 @@ UNICORN_API unistat uni_collate(const void *s1, unisize s1_len, uniattr s1_attr,
     struct SortKey sk1;
     struct SortKey sk2;
 
-    sortkeybuf_init(&sk1, weighting, strength);
-    sortkeybuf_init(&sk2, weighting, strength);
+    sortkeybuf_init(&sk1, weighting, strength, workspace);
+    sortkeybuf_init(&sk2, weighting, strength, workspace);
 
     if (result == NULL)
     {
@@ -413,6 +418,28 @@ UNICORN_API unistat uni_collate(const void *s1, unisize s1_len, uniattr s1_attr,
 #endif
 }
 
+UNICORN_API unistat uni_collate(const void *s1, unisize s1_len, uniattr s1_attr, const void *s2, unisize s2_len, uniattr s2_attr, uniweighting weighting, unistrength strength, int32_t *result) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+{
+    return uni_collatews(s1, s1_len, s1_attr, s2, s2_len, s2_attr, weighting, strength, result, NULL);
+}
+
+UNICORN_API unistat uni_viewcollate(const uniview *v1, const uniview *v2, uniweighting weighting, unistrength strength, int32_t *result) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+{
+    unistat status;
+
+    if ((v1 == NULL) || (v2 == NULL))
+    {
+        uni_message("required argument is null");
+        status = UNI_BAD_OPERATION;
+    }
+    else
+    {
+        status = uni_collate(v1->text, v1->text_len, v1->text_attr, v2->text, v2->text_len, v2->text_attr, weighting, strength, result);
+    }
+
+    return status;
+}
+
 UNICORN_API unistat uni_sortkeycmp(const uint16_t *sk1, size_t sk1_len, const uint16_t *sk2, size_t sk2_len, int32_t *result) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
 {
 #if defined(UNICORN_FEATURE_COLLATION)
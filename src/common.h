@@ -18,7 +18,7 @@
 #include <string.h>
 #include <assert.h>
 
-#define GET_ENCODING(FLAGS) ((FLAGS) & (UNI_SCALAR | UNI_UTF8 | UNI_UTF16 | UNI_UTF32))
+#define GET_ENCODING(FLAGS) ((FLAGS) & (UNI_SCALAR | UNI_UTF8 | UNI_UTF16 | UNI_UTF32 | UNI_LATIN1 | UNI_CP1252))
 
 #define UNICHAR_C(X) ((unichar)(X))
 #define UNISIZE_C(X) ((unisize)(X))
@@ -50,14 +50,30 @@ void *uni_malloc(size_t size);
 void *uni_realloc(void *old_ptr, size_t old_size, size_t new_size);
 void uni_free(void *ptr, size_t size);
 
-unisize unichar_to_u8(unichar codepoint, unichar8 bytes[4]);
-unisize unichar_to_u16(unichar codepoint, unichar16 words[2], ByteSwap16 swap); // cppcheck-suppress premium-misra-c-2012-17.3 ; This is a false positive.
+// Allocates and frees with the process-wide allocator ignoring the context of the calling thread.
+void *uni_global_malloc(size_t size);
+void *uni_global_realloc(void *old_ptr, size_t old_size, size_t new_size);
+void uni_global_free(void *ptr, size_t size);
+
+// Returns 'true' if the context of the calling thread forbids heap allocation.
+bool uni_heap_disabled(void);
+
+// Maps between Windows-1252 bytes and code points. Encoding fails for
+// code points that have no representation in Windows-1252.
+unichar cp1252_to_unichar(unichar8 byte);
+bool unichar_to_cp1252(unichar codepoint, unichar8 *byte);
 
 unisize uni_prev_UTF8_seqlen(const unichar8 *start, unisize offset);
 
+unistat uni_check_encoding(uniattr *encoding);
 unistat uni_check_input_encoding(const void *text, unisize length, uniattr *encoding);
 unistat uni_check_output_encoding(const void *buffer, const unisize *capacity, uniattr *encoding);
 
+// Decodes the next or previous character without verifying the arguments.
+// The text attributes must have been resolved by uni_check_input_encoding().
+unistat uni_nextchar(const void *text, unisize text_len, uniattr text_attr, unisize *index, unichar *cp);
+unistat uni_prevchar(const void *text, unisize text_len, uniattr text_attr, unisize *index, unichar *cp);
+
 void uni_message(const char *msg);
 
 static inline bool is_low_surrogate(unichar c)
@@ -96,6 +112,78 @@ static inline bool is_high_surrogate(unichar c)
     return is_high;
 }
 
+// Hash functions of the seeded perfect hash tables generated for special casing and canonical
+// composition. Their seeds were computed with these exact functions so they must not change.
+static inline unihash uni_hash_char(unichar cp)
+{
+    unihash hash = (unihash)cp;
+    hash = ((hash >> UNIHASH_C(16)) ^ hash) * UNIHASH_C(0x45D9F3B);
+    hash = ((hash >> UNIHASH_C(16)) ^ hash) * UNIHASH_C(0x45D9F3B);
+    hash = (hash >> UNIHASH_C(16)) ^ hash;
+    return hash;
+}
+
+static inline unihash uni_xorshift(unihash x)
+{
+    unihash hash = x;
+    hash ^= hash << UNIHASH_C(13);
+    hash ^= hash >> UNIHASH_C(17);
+    hash ^= hash << UNIHASH_C(5);
+    return hash;
+}
+
+// Encodes the code point, writing its code units to the array. These are inline because
+// they're on the hot path of every algorithm that writes UTF-8 or UTF-16.
+static inline unisize unichar_to_u8(unichar codepoint, unichar8 bytes[4])
+{
+    unisize length;
+    if (codepoint <= UNICHAR_C(0x7F))
+    {
+        bytes[0] = (unichar8)codepoint;
+        length = 1;
+    }
+    else if (codepoint <= UNICHAR_C(0x7FF))
+    {
+        bytes[0] = (unichar8)(codepoint >> UNICHAR_C(6)) | (uint8_t)0xC0;
+        bytes[1] = (unichar8)(codepoint & UNICHAR_C(0x3F)) | (uint8_t)0x80;
+        length = 2;
+    }
+    else if (codepoint <= UNICHAR_C(0xFFFF))
+    {
+        bytes[0] = (unichar8)(codepoint >> UNICHAR_C(12)) | (uint8_t)0xE0;
+        bytes[1] = (unichar8)((codepoint >> UNICHAR_C(6)) & UNICHAR_C(0x3F)) | (uint8_t)0x80;
+        bytes[2] = (unichar8)(codepoint & UNICHAR_C(0x3F)) | (uint8_t)0x80;
+        length = 3;
+    }
+    else
+    {
+        assert(codepoint <= UNICHAR_C(0x10FFFF)); // LCOV_EXCL_BR_LINE
+        bytes[0] = (unichar8)(codepoint >> UNICHAR_C(18)) | (uint8_t)0xF0;
+        bytes[1] = (unichar8)((codepoint >> UNICHAR_C(12)) & UNICHAR_C(0x3F)) | (uint8_t)0x80;
+        bytes[2] = (unichar8)((codepoint >> UNICHAR_C(6)) & UNICHAR_C(0x3F)) | (uint8_t)0x80;
+        bytes[3] = (unichar8)(codepoint & UNICHAR_C(0x3F)) | (uint8_t)0x80;
+        length = 4;
+    }
+    return length;
+}
+
+static inline unisize unichar_to_u16(unichar codepoint, unichar16 words[2], ByteSwap16 swap) // cppcheck-suppress premium-misra-c-2012-17.3 ; This is a false positive.
+{
+    unisize length = 1;
+    if (codepoint <= (unichar)0xFFFF)
+    {
+        words[0] = swap((unichar16)codepoint);
+    }
+    else
+    {
+        const unichar LEAD_OFFSET = (unichar)0xD800 - ((unichar)0x10000 >> (unichar)10);
+        words[0] = swap((unichar16)(LEAD_OFFSET + (codepoint >> (unichar)10)));
+        words[1] = swap((unichar16)((unichar)0xDC00 + (codepoint & (unichar)0x3FF)));
+        length = 2;
+    }
+    return length;
+}
+
 #if defined(_MSC_VER)
 #define UNREACHABLE __assume(false)
 #elif defined(__GNUC__) || defined(__clang__)
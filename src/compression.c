@@ -483,7 +483,7 @@ UNICORN_API unistat uni_compress(const void *text, unisize text_len, uniattr tex
         for (;;)
         {
             unichar cp;
-            status = uni_next(it.data, it.length, it.encoding, &it.index, &cp);
+            status = uni_nextchar(it.data, it.length, it.encoding, &it.index, &cp);
             if (status != UNI_OK)
             {
                 if (status == UNI_DONE)
@@ -572,9 +572,26 @@ UNICORN_API unistat uni_decompress(const uint8_t *buffer, size_t buffer_length,
    
     if (status == UNI_OK)
     {
+        // The decoder state between code points is the previous code point therefore
+        // it's recorded with each checkpoint so decoding can resume from there.
         struct bocudecoder decoder = {.prev = BOCU1_ASCII_PREV};
-        for (size_t i = 0; i < buffer_length; i++)
+        int32_t prev = 0;
+        const size_t start = (size_t)uni_charbuf_resume(&output, &prev);
+        if (start > (size_t)0)
         {
+            decoder.prev = prev;
+        }
+
+        for (size_t i = start; i < buffer_length; i++)
+        {
+            if ((decoder.count == 0) && (i <= (size_t)INT32_MAX))
+            {
+                if (uni_charbuf_checkpoint(&output, (unisize)i, decoder.prev))
+                {
+                    break;
+                }
+            }
+
             unichar cp;
             const int32_t byte = (int32_t)buffer[i];
             enum decoderstate state = DECODER_OK;
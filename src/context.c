@@ -0,0 +1,60 @@
+/*
+ *  Unicorn - Embeddable Unicode Algorithms
+ *  Copyright (c) 2024-2026 Railgun Labs
+ *
+ *  This software is dual-licensed: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation. For the terms of this
+ *  license, see <https://www.gnu.org/licenses/>.
+ *
+ *  Alternatively, you can license this software under a proprietary
+ *  license, as set out in <https://railgunlabs.com/unicorn/license/>.
+ */
+
+#include "common.h"
+
+// C99 has no thread-local storage therefore compiler extensions are used when
+// the compiler isn't C11 or newer. Without thread-local storage contexts can't
+// be installed and the library always uses the process-wide configuration.
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L) && !defined(__STDC_NO_THREADS__)
+#define UNICORN_THREAD_LOCAL _Thread_local
+#elif defined(_MSC_VER)
+#define UNICORN_THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__) || defined(__clang__)
+#define UNICORN_THREAD_LOCAL __thread
+#endif
+
+#if defined(UNICORN_THREAD_LOCAL)
+// Context installed by the calling thread or null if the thread uses the process-wide configuration.
+static UNICORN_THREAD_LOCAL const unicontext *unicorn_context;
+#endif
+
+UNICORN_API unistat uni_setcontext(const unicontext *context) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+{
+    unistat status = UNI_OK;
+#if defined(UNICORN_THREAD_LOCAL)
+    unicorn_context = context;
+#else
+    if (context != NULL)
+    {
+        uni_message("thread-local storage is unavailable");
+        status = UNI_FEATURE_DISABLED;
+    }
+#endif
+    return status;
+}
+
+UNICORN_API const unicontext *uni_getcontext(void) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+{
+#if defined(UNICORN_THREAD_LOCAL)
+    return unicorn_context;
+#else
+    return NULL;
+#endif
+}
+
+bool uni_heap_disabled(void)
+{
+    const unicontext *context = uni_getcontext();
+    return (context != NULL) && ((context->options & UNI_NO_HEAP) == UNI_NO_HEAP);
+}
@@ -0,0 +1,231 @@
+/*
+ *  Unicorn - Embeddable Unicode Algorithms
+ *  Copyright (c) 2024-2026 Railgun Labs
+ *
+ *  This software is dual-licensed: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation. For the terms of this
+ *  license, see <https://www.gnu.org/licenses/>.
+ *
+ *  Alternatively, you can license this software under a proprietary
+ *  license, as set out in <https://railgunlabs.com/unicorn/license/>.
+ */
+
+#include "cpu.h"
+
+#if defined(UNICORN_HAVE_X86_SIMD) && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+// Features the kernels are permitted to use. This is configured by the caller.
+static unicpu unicorn_cpu_mask = UNI_CPU_ALL;
+
+// Kernels selected for the running CPU. They are resolved on first use rather than
+// in a static initializer because C99 has no portable mechanism for running code at
+// load time. If multiple threads race to resolve the kernels, they all store the same
+// pointer so the outcome is the same regardless of which store is observed.
+static const struct Kernels *unicorn_kernels;
+
+#if defined(UNICORN_HAVE_X86_SIMD)
+// The vectorized kernels that load or store scalar values process them as 32-bit lanes
+// therefore they are only selected when unichar is configured as a 32-bit integer.
+#if UNICORN_CHAR_STORAGE_BITS == 32
+#define ASCII_WIDEN_SSE2 &uni_ASCII_widen_sse2
+#define LATIN1_WIDEN_SSE2 &uni_LATIN1_widen_sse2
+#define SCALAR_TO_ASCII_SSE2 &uni_SCALAR_to_ASCII_sse2
+#define SCALAR_TO_LATIN1_SSE2 &uni_SCALAR_to_LATIN1_sse2
+#define SCALAR_TO_UTF16_SSE2 &uni_SCALAR_to_UTF16_sse2
+#else
+#define ASCII_WIDEN_SSE2 &uni_ASCII_widen_scalar
+#define LATIN1_WIDEN_SSE2 &uni_LATIN1_widen_scalar
+#define SCALAR_TO_ASCII_SSE2 &uni_SCALAR_to_ASCII_scalar
+#define SCALAR_TO_LATIN1_SSE2 &uni_SCALAR_to_LATIN1_scalar
+#define SCALAR_TO_UTF16_SSE2 &uni_SCALAR_to_UTF16_scalar
+#endif
+#endif
+
+static unicpu detect_features(void)
+{
+    unicpu features = 0;
+#if defined(UNICORN_HAVE_X86_SIMD)
+    // SSE2 is part of the x86-64 baseline.
+    features |= UNI_CPU_SSE2;
+#if defined(_MSC_VER)
+    int regs[4];
+    __cpuid(regs, 0);
+    const int max_leaf = regs[0];
+
+    __cpuid(regs, 1);
+    if ((((uint32_t)regs[2] >> 20) & 1u) == 1u)
+    {
+        features |= UNI_CPU_SSE42;
+    }
+
+    // AVX2 requires the OS to save the YMM registers (OSXSAVE and AVX bits).
+    if ((max_leaf >= 7) && ((((uint32_t)regs[2] >> 27) & 3u) == 3u))
+    {
+        if ((_xgetbv(0) & 6u) == 6u)
+        {
+            __cpuidex(regs, 7, 0);
+            if ((((uint32_t)regs[1] >> 5) & 1u) == 1u)
+            {
+                features |= UNI_CPU_AVX2;
+            }
+        }
+    }
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2") != 0)
+    {
+        features |= UNI_CPU_SSE42;
+    }
+
+    if (__builtin_cpu_supports("avx2") != 0)
+    {
+        features |= UNI_CPU_AVX2;
+    }
+#endif
+#endif
+    return features;
+}
+
+static const struct Kernels *select_kernels(unicpu features)
+{
+    static const struct Kernels scalar = {
+        .UTF8_valid_prefix = &uni_UTF8_valid_prefix_scalar,
+        .ASCII_widen = &uni_ASCII_widen_scalar,
+        .ASCII_to_UTF16 = &uni_ASCII_to_UTF16_scalar,
+        .UTF16_to_ASCII = &uni_UTF16_to_ASCII_scalar,
+        .ASCII_prefix = &uni_ASCII_prefix_scalar,
+        .LATIN1_widen = &uni_LATIN1_widen_scalar,
+        .LATIN1_to_UTF16 = &uni_LATIN1_to_UTF16_scalar,
+        .UTF16_to_LATIN1 = &uni_UTF16_to_LATIN1_scalar,
+        .LATIN1_to_UTF8 = &uni_LATIN1_to_UTF8_scalar,
+        .UTF8_to_LATIN1 = &uni_UTF8_to_LATIN1_scalar,
+        .UTF8_to_UTF16 = &uni_UTF8_to_UTF16_scalar,
+        .UTF16_to_UTF8 = &uni_UTF16_to_UTF8_scalar,
+        .SCALAR_to_ASCII = &uni_SCALAR_to_ASCII_scalar,
+        .SCALAR_to_LATIN1 = &uni_SCALAR_to_LATIN1_scalar,
+        .SCALAR_to_UTF16 = &uni_SCALAR_to_UTF16_scalar,
+        .UTF8_count = &uni_UTF8_count_scalar,
+        .UTF16_count = &uni_UTF16_count_scalar,
+        .UTF16_copy = &uni_UTF16_copy_scalar,
+        .UTF32_copy = &uni_UTF32_copy_scalar,
+    };
+
+#if defined(UNICORN_HAVE_X86_SIMD)
+    static const struct Kernels sse2 = {
+        .UTF8_valid_prefix = &uni_UTF8_valid_prefix_scalar,
+        .ASCII_widen = ASCII_WIDEN_SSE2,
+        .ASCII_to_UTF16 = &uni_ASCII_to_UTF16_sse2,
+        .UTF16_to_ASCII = &uni_UTF16_to_ASCII_sse2,
+        .ASCII_prefix = &uni_ASCII_prefix_sse2,
+        .LATIN1_widen = LATIN1_WIDEN_SSE2,
+        .LATIN1_to_UTF16 = &uni_LATIN1_to_UTF16_sse2,
+        .UTF16_to_LATIN1 = &uni_UTF16_to_LATIN1_sse2,
+        .LATIN1_to_UTF8 = &uni_LATIN1_to_UTF8_sse2,
+        .UTF8_to_LATIN1 = &uni_UTF8_to_LATIN1_sse2,
+        .UTF8_to_UTF16 = &uni_UTF8_to_UTF16_sse2,
+        .UTF16_to_UTF8 = &uni_UTF16_to_UTF8_sse2,
+        .SCALAR_to_ASCII = SCALAR_TO_ASCII_SSE2,
+        .SCALAR_to_LATIN1 = SCALAR_TO_LATIN1_SSE2,
+        .SCALAR_to_UTF16 = SCALAR_TO_UTF16_SSE2,
+        .UTF8_count = &uni_UTF8_count_sse2,
+        .UTF16_count = &uni_UTF16_count_sse2,
+        .UTF16_copy = &uni_UTF16_copy_sse2,
+        .UTF32_copy = &uni_UTF32_copy_sse2,
+    };
+
+    static const struct Kernels sse42 = {
+        .UTF8_valid_prefix = &uni_UTF8_valid_prefix_sse42,
+        .ASCII_widen = ASCII_WIDEN_SSE2,
+        .ASCII_to_UTF16 = &uni_ASCII_to_UTF16_sse2,
+        .UTF16_to_ASCII = &uni_UTF16_to_ASCII_sse2,
+        .ASCII_prefix = &uni_ASCII_prefix_sse2,
+        .LATIN1_widen = LATIN1_WIDEN_SSE2,
+        .LATIN1_to_UTF16 = &uni_LATIN1_to_UTF16_sse2,
+        .UTF16_to_LATIN1 = &uni_UTF16_to_LATIN1_sse2,
+        .LATIN1_to_UTF8 = &uni_LATIN1_to_UTF8_sse2,
+        .UTF8_to_LATIN1 = &uni_UTF8_to_LATIN1_sse2,
+        .UTF8_to_UTF16 = &uni_UTF8_to_UTF16_sse42,
+        .UTF16_to_UTF8 = &uni_UTF16_to_UTF8_sse42,
+        .SCALAR_to_ASCII = SCALAR_TO_ASCII_SSE2,
+        .SCALAR_to_LATIN1 = SCALAR_TO_LATIN1_SSE2,
+        .SCALAR_to_UTF16 = SCALAR_TO_UTF16_SSE2,
+        .UTF8_count = &uni_UTF8_count_sse2,
+        .UTF16_count = &uni_UTF16_count_sse2,
+        .UTF16_copy = &uni_UTF16_copy_sse2,
+        .UTF32_copy = &uni_UTF32_copy_sse2,
+    };
+
+    static const struct Kernels avx2 = {
+        .UTF8_valid_prefix = &uni_UTF8_valid_prefix_avx2,
+        .ASCII_widen = ASCII_WIDEN_SSE2,
+        .ASCII_to_UTF16 = &uni_ASCII_to_UTF16_sse2,
+        .UTF16_to_ASCII = &uni_UTF16_to_ASCII_sse2,
+        .ASCII_prefix = &uni_ASCII_prefix_sse2,
+        .LATIN1_widen = LATIN1_WIDEN_SSE2,
+        .LATIN1_to_UTF16 = &uni_LATIN1_to_UTF16_sse2,
+        .UTF16_to_LATIN1 = &uni_UTF16_to_LATIN1_sse2,
+        .LATIN1_to_UTF8 = &uni_LATIN1_to_UTF8_sse2,
+        .UTF8_to_LATIN1 = &uni_UTF8_to_LATIN1_sse2,
+        .UTF8_to_UTF16 = &uni_UTF8_to_UTF16_sse42,
+        .UTF16_to_UTF8 = &uni_UTF16_to_UTF8_sse42,
+        .SCALAR_to_ASCII = SCALAR_TO_ASCII_SSE2,
+        .SCALAR_to_LATIN1 = SCALAR_TO_LATIN1_SSE2,
+        .SCALAR_to_UTF16 = SCALAR_TO_UTF16_SSE2,
+        .UTF8_count = &uni_UTF8_count_sse2,
+        .UTF16_count = &uni_UTF16_count_sse2,
+        .UTF16_copy = &uni_UTF16_copy_avx2,
+        .UTF32_copy = &uni_UTF32_copy_avx2,
+    };
+#endif
+
+    const struct Kernels *kernels = &scalar;
+
+#if defined(UNICORN_HAVE_X86_SIMD)
+    if ((features & UNI_CPU_AVX2) == UNI_CPU_AVX2)
+    {
+        kernels = &avx2;
+    }
+    else if ((features & UNI_CPU_SSE42) == UNI_CPU_SSE42)
+    {
+        kernels = &sse42;
+    }
+    else if ((features & UNI_CPU_SSE2) == UNI_CPU_SSE2)
+    {
+        kernels = &sse2;
+    }
+    else
+    {
+        // No Action.
+    }
+#else
+    (void)features;
+#endif
+
+    return kernels;
+}
+
+const struct Kernels *uni_kernels(void)
+{
+    const struct Kernels *kernels = unicorn_kernels;
+    if (kernels == NULL)
+    {
+        kernels = select_kernels(detect_features() & unicorn_cpu_mask);
+        unicorn_kernels = kernels;
+    }
+    return kernels;
+}
+
+UNICORN_API unicpu uni_getcpufeatures(void) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+{
+    return detect_features();
+}
+
+UNICORN_API void uni_setcpufeatures(unicpu features) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+{
+    unicorn_cpu_mask = features;
+    unicorn_kernels = select_kernels(detect_features() & features);
+}
@@ -0,0 +1,47 @@
+/*
+ *  Unicorn - Embeddable Unicode Algorithms
+ *  Copyright (c) 2024-2026 Railgun Labs
+ *
+ *  This software is dual-licensed: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation. For the terms of this
+ *  license, see <https://www.gnu.org/licenses/>.
+ *
+ *  Alternatively, you can license this software under a proprietary
+ *  license, as set out in <https://railgunlabs.com/unicorn/license/>.
+ */
+
+#ifndef CPU_H
+#define CPU_H
+
+#include "simd.h"
+
+// Dispatch table for the bulk processing kernels. Each member points to the
+// best implementation for the running CPU and enabled CPU features. To add a
+// kernel, add a member here and assign its implementations in cpu.c.
+struct Kernels
+{
+    unisize (*UTF8_valid_prefix)(const unichar8 *bytes, unisize length);
+    unisize (*ASCII_widen)(const unichar8 *bytes, unisize length, unichar *chars);
+    unisize (*ASCII_to_UTF16)(const unichar8 *bytes, unisize length, unichar16 *words, bool is_big);
+    unisize (*UTF16_to_ASCII)(const unichar16 *words, unisize length, unichar8 *bytes, bool is_big);
+    unisize (*ASCII_prefix)(const unichar8 *bytes, unisize length);
+    unisize (*LATIN1_widen)(const unichar8 *bytes, unisize length, unichar *chars);
+    unisize (*LATIN1_to_UTF16)(const unichar8 *bytes, unisize length, unichar16 *words, bool is_big);
+    unisize (*UTF16_to_LATIN1)(const unichar16 *words, unisize length, unichar8 *bytes, bool is_big);
+    unisize (*LATIN1_to_UTF8)(const unichar8 *bytes, unisize length, unichar8 *out, unisize capacity, unisize *written);
+    unisize (*UTF8_to_LATIN1)(const unichar8 *bytes, unisize length, unichar8 *out, unisize *consumed);
+    unisize (*UTF8_to_UTF16)(const unichar8 *bytes, unisize length, unichar16 *words, unisize capacity, bool is_big, unisize *written);
+    unisize (*UTF16_to_UTF8)(const unichar16 *words, unisize length, unichar8 *out, unisize capacity, bool is_big, unisize *written);
+    unisize (*SCALAR_to_ASCII)(const unichar *chars, unisize length, unichar8 *bytes);
+    unisize (*SCALAR_to_LATIN1)(const unichar *chars, unisize length, unichar8 *bytes);
+    unisize (*SCALAR_to_UTF16)(const unichar *chars, unisize length, unichar16 *words, bool is_big);
+    unisize (*UTF8_count)(const unichar8 *bytes, unisize length, unisize *supplementary);
+    unisize (*UTF16_count)(const unichar16 *words, unisize length, bool is_big, unisize *bytes_length);
+    unisize (*UTF16_copy)(const unichar16 *src, unisize length, unichar16 *dst, bool is_big, bool swap);
+    unisize (*UTF32_copy)(const unichar32 *src, unisize length, unichar32 *dst, bool is_big, bool swap);
+};
+
+const struct Kernels *uni_kernels(void);
+
+#endif // CPU_H
@@ -248,11 +248,20 @@ static void collect_collation_elements(struct CharVec *charvec, struct CEDecoder
     }
 }
 
-void uni_cebuf_init(struct CEDecoder *state)
+void uni_cebuf_init(struct CEDecoder *state, uniworkspace *workspace)
 {
     (void)memset(state, 0, sizeof(state[0]));
-    uni_norm_init(&state->normbuf, &uni_is_stable_nfd);
-    uni_charvec_init(&state->charvec);
+    uni_norm_init(&state->normbuf, &uni_is_stable_nfd, workspace);
+    uni_charvec_init(&state->charvec, workspace);
+    if (state->normbuf.limit > 0)
+    {
+        // Normalized runs are appended after the characters left over from the previous run.
+        const unisize limit = uni_charvec_capacity(&state->charvec) - LONGEST_INITIAL_SUBSTRING;
+        if (state->normbuf.limit > limit)
+        {
+            state->normbuf.limit = limit;
+        }
+    }
 }
 
 void uni_cebuf_free(struct CEDecoder *state)
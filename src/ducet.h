@@ -35,7 +35,7 @@ struct CEDecoder
     CE ces[UNICORN_MAX_COLLATION];
 };
 
-void uni_cebuf_init(struct CEDecoder *state);
+void uni_cebuf_init(struct CEDecoder *state, uniworkspace *workspace);
 void uni_cebuf_free(struct CEDecoder *state);
 bool uni_cebuf_is_empty(const struct CEDecoder *state);
 CE uni_cebuf_pop(struct CEDecoder *state);
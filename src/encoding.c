@@ -13,6 +13,7 @@
 
 #include "charbuf.h"
 #include "byteswap.h"
+#include "cpu.h"
 #include "unidata.h"
 
 /*
@@ -55,40 +56,82 @@ static const uint8_t bytes_needed_for_UTF8_sequence[] = {
     0x07,  // Four byte sequence: 11110xxx 10xxxxxx 10xxxxxx 10xxxxxx.
 };
 
-// See "next_utf8_byte.dot" for a visualization of the DFA.
-static const uint8_t unicorn_next_UTF8_DFA[] = {
-    0, 12, 24, 36, 60, 96, 84, 12, 12, 12, 48, 72,  // state 0
-    12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, // state 1
-    12, 0, 12, 12, 12, 12, 12, 0, 12, 0, 12, 12,    // state 2
-    12, 24, 12, 12, 12, 12, 12, 24, 12, 24, 12, 12, // state 3
-    12, 12, 12, 12, 12, 12, 12, 24, 12, 12, 12, 12, // state 4
-    12, 24, 12, 12, 12, 12, 12, 12, 12, 24, 12, 12, // state 5
-    12, 12, 12, 12, 12, 12, 12, 36, 12, 36, 12, 12, // state 6
-    12, 36, 12, 12, 12, 12, 12, 36, 12, 36, 12, 12, // state 7
-    12, 36, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, // state 8
-};
-
-// Character classes for the UTF-8 DFA.
-static const uint8_t unicorn_byte_to_character_class[] = {
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
-    9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9,
-    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
-    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
-    8, 8, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
-    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
-    10, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 4, 3, 3,
-    11, 6, 6, 6, 5, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8,
+// Shift-based DFA for validating UTF-8. Each byte maps to a 64-bit row that packs the
+// transitions out of every state. States are bit offsets into the row, six bits apart, so a
+// transition is one table lookup and a shift with no dependence on a character class table.
+// The DFA has nine states: the acceptance state (0), the rejection state (6), and seven
+// states for partially decoded sequences. See "next_utf8_byte.dot" for a visualization.
+static const uint64_t unicorn_UTF8_DFA[] = {
+    UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180),
+    UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180),
+    UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180),
+    UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180),
+    UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180),
+    UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180),
+    UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180),
+    UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180),
+    UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180),
+    UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180),
+    UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180),
+    UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180),
+    UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180),
+    UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180),
+    UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180),
+    UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180),
+    UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180),
+    UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180),
+    UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180),
+    UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180),
+    UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180),
+    UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180),
+    UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180),
+    UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180),
+    UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180),
+    UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180),
+    UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180),
+    UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180),
+    UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180),
+    UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180),
+    UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180),
+    UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180), UINT64_C(0x06186186186180),
+    UINT64_C(0x12486306300186), UINT64_C(0x12486306300186), UINT64_C(0x12486306300186), UINT64_C(0x12486306300186),
+    UINT64_C(0x12486306300186), UINT64_C(0x12486306300186), UINT64_C(0x12486306300186), UINT64_C(0x12486306300186),
+    UINT64_C(0x12486306300186), UINT64_C(0x12486306300186), UINT64_C(0x12486306300186), UINT64_C(0x12486306300186),
+    UINT64_C(0x12486306300186), UINT64_C(0x12486306300186), UINT64_C(0x12486306300186), UINT64_C(0x12486306300186),
+    UINT64_C(0x06492306300186), UINT64_C(0x06492306300186), UINT64_C(0x06492306300186), UINT64_C(0x06492306300186),
+    UINT64_C(0x06492306300186), UINT64_C(0x06492306300186), UINT64_C(0x06492306300186), UINT64_C(0x06492306300186),
+    UINT64_C(0x06492306300186), UINT64_C(0x06492306300186), UINT64_C(0x06492306300186), UINT64_C(0x06492306300186),
+    UINT64_C(0x06492306300186), UINT64_C(0x06492306300186), UINT64_C(0x06492306300186), UINT64_C(0x06492306300186),
+    UINT64_C(0x0649218C300186), UINT64_C(0x0649218C300186), UINT64_C(0x0649218C300186), UINT64_C(0x0649218C300186),
+    UINT64_C(0x0649218C300186), UINT64_C(0x0649218C300186), UINT64_C(0x0649218C300186), UINT64_C(0x0649218C300186),
+    UINT64_C(0x0649218C300186), UINT64_C(0x0649218C300186), UINT64_C(0x0649218C300186), UINT64_C(0x0649218C300186),
+    UINT64_C(0x0649218C300186), UINT64_C(0x0649218C300186), UINT64_C(0x0649218C300186), UINT64_C(0x0649218C300186),
+    UINT64_C(0x0649218C300186), UINT64_C(0x0649218C300186), UINT64_C(0x0649218C300186), UINT64_C(0x0649218C300186),
+    UINT64_C(0x0649218C300186), UINT64_C(0x0649218C300186), UINT64_C(0x0649218C300186), UINT64_C(0x0649218C300186),
+    UINT64_C(0x0649218C300186), UINT64_C(0x0649218C300186), UINT64_C(0x0649218C300186), UINT64_C(0x0649218C300186),
+    UINT64_C(0x0649218C300186), UINT64_C(0x0649218C300186), UINT64_C(0x0649218C300186), UINT64_C(0x0649218C300186),
+    UINT64_C(0x06186186186186), UINT64_C(0x06186186186186), UINT64_C(0x0618618618618C), UINT64_C(0x0618618618618C),
+    UINT64_C(0x0618618618618C), UINT64_C(0x0618618618618C), UINT64_C(0x0618618618618C), UINT64_C(0x0618618618618C),
+    UINT64_C(0x0618618618618C), UINT64_C(0x0618618618618C), UINT64_C(0x0618618618618C), UINT64_C(0x0618618618618C),
+    UINT64_C(0x0618618618618C), UINT64_C(0x0618618618618C), UINT64_C(0x0618618618618C), UINT64_C(0x0618618618618C),
+    UINT64_C(0x0618618618618C), UINT64_C(0x0618618618618C), UINT64_C(0x0618618618618C), UINT64_C(0x0618618618618C),
+    UINT64_C(0x0618618618618C), UINT64_C(0x0618618618618C), UINT64_C(0x0618618618618C), UINT64_C(0x0618618618618C),
+    UINT64_C(0x0618618618618C), UINT64_C(0x0618618618618C), UINT64_C(0x0618618618618C), UINT64_C(0x0618618618618C),
+    UINT64_C(0x0618618618618C), UINT64_C(0x0618618618618C), UINT64_C(0x0618618618618C), UINT64_C(0x0618618618618C),
+    UINT64_C(0x06186186186198), UINT64_C(0x06186186186192), UINT64_C(0x06186186186192), UINT64_C(0x06186186186192),
+    UINT64_C(0x06186186186192), UINT64_C(0x06186186186192), UINT64_C(0x06186186186192), UINT64_C(0x06186186186192),
+    UINT64_C(0x06186186186192), UINT64_C(0x06186186186192), UINT64_C(0x06186186186192), UINT64_C(0x06186186186192),
+    UINT64_C(0x06186186186192), UINT64_C(0x0618618618619E), UINT64_C(0x06186186186192), UINT64_C(0x06186186186192),
+    UINT64_C(0x061861861861A4), UINT64_C(0x061861861861AA), UINT64_C(0x061861861861AA), UINT64_C(0x061861861861AA),
+    UINT64_C(0x061861861861B0), UINT64_C(0x06186186186186), UINT64_C(0x06186186186186), UINT64_C(0x06186186186186),
+    UINT64_C(0x06186186186186), UINT64_C(0x06186186186186), UINT64_C(0x06186186186186), UINT64_C(0x06186186186186),
+    UINT64_C(0x06186186186186), UINT64_C(0x06186186186186), UINT64_C(0x06186186186186), UINT64_C(0x06186186186186),
 };
 
 #define DFA_ACCEPTANCE_STATE ((uint8_t)0) // The acceptance state for the UTF-8 validator DFA.
+#define DFA_REJECTION_STATE ((uint8_t)6) // The rejection state for the UTF-8 validator DFA.
+
+#define REPLACEMENT_CHARACTER UNICHAR_C(0xFFFD) // Substituted for malformed sequences with UNI_REPLACE.
 
 static bool is_non_surrogate_bmp(unichar word)
 {
@@ -190,58 +233,143 @@ unisize uni_prev_UTF8_seqlen(const unichar8 *start, unisize offset)
     return length;
 }
 
-unisize unichar_to_u8(unichar codepoint, unichar8 bytes[4])
+#if defined(UNICORN_FEATURE_ENCODING_CP1252)
+// Code points of the Windows-1252 bytes 0x80 through 0x9F. The remaining bytes are identical to
+// ISO-8859-1. The five bytes Windows-1252 leaves undefined decode to the C1 control character with
+// the same value, which is how the WHATWG Encoding Standard defines this encoding.
+static const uint16_t cp1252_high_controls[32] = {
+    0x20AC, 0x0081, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021,
+    0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0x008D, 0x017D, 0x008F,
+    0x0090, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014,
+    0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0x009D, 0x017E, 0x0178,
+};
+
+unichar cp1252_to_unichar(unichar8 byte)
 {
-    unisize length;
-    if (codepoint <= UNICHAR_C(0x7F))
+    unichar cp = (unichar)byte;
+    if ((byte >= (unichar8)0x80) && (byte <= (unichar8)0x9F))
     {
-        bytes[0] = (unichar8)codepoint;
-        length = 1;
+        cp = (unichar)cp1252_high_controls[byte - (unichar8)0x80];
+    }
+    return cp;
+}
+
+bool unichar_to_cp1252(unichar codepoint, unichar8 *byte)
+{
+    bool is_encodable = false;
+    if ((codepoint < UNICHAR_C(0x80)) || ((codepoint >= UNICHAR_C(0xA0)) && (codepoint <= UNICHAR_C(0xFF))))
+    {
+        *byte = (unichar8)codepoint;
+        is_encodable = true;
     }
-    else if (codepoint <= UNICHAR_C(0x7FF))
+    else
     {
-        bytes[0] = (unichar8)(codepoint >> UNICHAR_C(6)) | (uint8_t)0xC0;
-        bytes[1] = (unichar8)(codepoint & UNICHAR_C(0x3F)) | (uint8_t)0x80;
-        length = 2;
+        for (size_t i = 0; i < COUNT_OF(cp1252_high_controls); i++)
+        {
+            if ((unichar)cp1252_high_controls[i] == codepoint)
+            {
+                *byte = (unichar8)((size_t)0x80 + i);
+                is_encodable = true;
+                break;
+            }
+        }
     }
-    else if (codepoint <= UNICHAR_C(0xFFFF))
+    return is_encodable;
+}
+#endif
+
+#if defined(UNICORN_FEATURE_ENCODING_LATIN1) || defined(UNICORN_FEATURE_ENCODING_CP1252)
+// Decodes the next character of text in a single byte encoding. Every byte is a complete
+// character therefore the text can never be malformed.
+static unistat byte_next(const void *text, unisize text_length, unisize *offset, unichar *scalar, bool is_cp1252)
+{
+    // LCOV_EXCL_START
+    assert(text != NULL);
+    assert(offset != NULL);
+    assert(scalar != NULL);
+    // LCOV_EXCL_STOP
+
+    unistat status = UNI_OK;
+
+    if ((text_length >= 0) && (*offset >= text_length))
     {
-        bytes[0] = (unichar8)(codepoint >> UNICHAR_C(12)) | (uint8_t)0xE0;
-        bytes[1] = (unichar8)((codepoint >> UNICHAR_C(6)) & UNICHAR_C(0x3F)) | (uint8_t)0x80;
-        bytes[2] = (unichar8)(codepoint & UNICHAR_C(0x3F)) | (uint8_t)0x80;
-        length = 3;
+        status = UNI_DONE;
     }
     else
     {
-        assert(codepoint <= UNICHAR_C(0x10FFFF)); // LCOV_EXCL_BR_LINE
-        bytes[0] = (unichar8)(codepoint >> UNICHAR_C(18)) | (uint8_t)0xF0;
-        bytes[1] = (unichar8)((codepoint >> UNICHAR_C(12)) & UNICHAR_C(0x3F)) | (uint8_t)0x80;
-        bytes[2] = (unichar8)((codepoint >> UNICHAR_C(6)) & UNICHAR_C(0x3F)) | (uint8_t)0x80;
-        bytes[3] = (unichar8)(codepoint & UNICHAR_C(0x3F)) | (uint8_t)0x80;
-        length = 4;
+        const unichar8 *bytes = text; // cppcheck-suppress misra-c2012-11.5
+        const unichar8 byte = bytes[*offset];
+        if ((text_length < 0) && (byte == (unichar8)0))
+        {
+            status = UNI_DONE;
+        }
+        else
+        {
+            *offset += 1;
+#if defined(UNICORN_FEATURE_ENCODING_CP1252)
+            *scalar = is_cp1252 ? cp1252_to_unichar(byte) : (unichar)byte;
+#else
+            (void)is_cp1252;
+            *scalar = (unichar)byte;
+#endif
+        }
     }
-    return length;
+    return status;
 }
 
-unisize unichar_to_u16(unichar codepoint, unichar16 words[2], ByteSwap16 swap)
+static unistat byte_prev(const void *text, unisize *offset, unichar *scalar, bool is_cp1252)
 {
-    unisize length = 1;
-    if (codepoint <= (unichar)0xFFFF)
+    unistat status = UNI_OK;
+    if (*offset == 0)
     {
-        words[0] = swap((unichar16)codepoint);
+        status = UNI_DONE;
     }
     else
     {
-        const unichar LEAD_OFFSET = (unichar)0xD800 - ((unichar)0x10000 >> (unichar)10);
-        words[0] = swap((unichar16)(LEAD_OFFSET + (codepoint >> (unichar)10)));
-        words[1] = swap((unichar16)((unichar)0xDC00 + (codepoint & (unichar)0x3FF)));
-        length = 2;
+        const unichar8 *bytes = text; // cppcheck-suppress misra-c2012-11.5
+        const unichar8 byte = bytes[(*offset) - 1];
+        *offset -= 1;
+#if defined(UNICORN_FEATURE_ENCODING_CP1252)
+        *scalar = is_cp1252 ? cp1252_to_unichar(byte) : (unichar)byte;
+#else
+        (void)is_cp1252;
+        *scalar = (unichar)byte;
+#endif
     }
-    return length;
+    return status;
 }
+#endif
 
 #if defined(UNICORN_FEATURE_ENCODING_UTF8)
 
+// Transitions the UTF-8 DFA from 'state' on the next byte.
+static inline uint8_t u8_transition(uint8_t state, unichar8 byte)
+{
+    return (uint8_t)((unicorn_UTF8_DFA[byte] >> state) & UINT64_C(0x3F));
+}
+
+// Decodes the 'byte_count' bytes of a UTF-8 sequence and returns the final DFA state, which is
+// the acceptance state if, and only if, the sequence is well-formed. The DFA transitions and
+// the scalar value accumulate side-by-side without branching on the bytes themselves.
+static inline uint8_t u8_decode_sequence(const unichar8 *bytes, unisize byte_count, unichar *scalar)
+{
+    // Consume the first byte.
+    unichar value = (unichar)bytes[0] & (unichar)bytes_needed_for_UTF8_sequence[256 + byte_count];
+    uint8_t state = u8_transition(DFA_ACCEPTANCE_STATE, bytes[0]);
+
+    // Consume the remaining bytes.
+    for (unisize i = 1; i < byte_count; i++)
+    {
+        // Mask off the next byte.
+        // It's of the form 10xxxxxx if valid UTF-8.
+        value = (value << UNICHAR_C(6)) | ((unichar)bytes[i] & UNICHAR_C(0x3F));
+        state = u8_transition(state, bytes[i]);
+    }
+
+    *scalar = value;
+    return state;
+}
+
 static unisize u8_decode_unsafe(const unichar8 *bytes, unichar *scalar)
 {
     // Fast but unsafe lookup table for determining how many bytes are in a UTF-8 encoded sequence.
@@ -270,35 +398,9 @@ static unisize u8_decode_unsafe(const unichar8 *bytes, unichar *scalar)
         4, 4, 4, 4, 4,
                        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // These bytes do not appear in valid UTF-8 sequences.
     };
+    // The DFA state is discarded because trusted text is assumed to be well-formed.
     const unisize bytes_needed = (unisize)unsafe_utf8_sequence_lengths[bytes[0]];
-    unichar cp;
-    switch (bytes_needed)
-    {
-    case 1:
-        // Single byte (i.e. fits in ASCII).
-        cp = (unichar)bytes[0];
-        break;
-    case 2:
-        // Two byte sequence: 110xxxxx 10xxxxxx.
-        cp = (unichar)bytes[0] & UNICHAR_C(0x1F);
-        cp = (cp << UNICHAR_C(6)) | ((unichar)bytes[1] & UNICHAR_C(0x3F));
-        break;
-    case 3:
-        // Three byte sequence: 1110xxxx 10xxxxxx 10xxxxxx.
-        cp = (unichar)bytes[0] & UNICHAR_C(0x0F);
-        cp = (cp << UNICHAR_C(6)) | ((unichar)bytes[1] & UNICHAR_C(0x3F));
-        cp = (cp << UNICHAR_C(6)) | ((unichar)bytes[2] & UNICHAR_C(0x3F));
-        break;
-    default:
-        assert(bytes_needed == 4); // LCOV_EXCL_BR_LINE
-        // Four byte sequence: 11110xxx 10xxxxxx 10xxxxxx 10xxxxxx.
-        cp = (unichar)bytes[0] & UNICHAR_C(0x07);
-        cp = (cp << UNICHAR_C(6)) | ((unichar)bytes[1] & UNICHAR_C(0x3F));
-        cp = (cp << UNICHAR_C(6)) | ((unichar)bytes[2] & UNICHAR_C(0x3F));
-        cp = (cp << UNICHAR_C(6)) | ((unichar)bytes[3] & UNICHAR_C(0x3F));
-        break;
-    }
-    *scalar = cp;
+    (void)u8_decode_sequence(bytes, bytes_needed, scalar);
     return bytes_needed;
 }
 
@@ -388,26 +490,9 @@ static unistat u8_next(const void *text, unisize text_length, unisize *offset, u
 
             if (status == UNI_OK)
             {
-                // Consume the first byte.
-                unichar value = (unichar)curr[0] & (unichar)bytes_needed_for_UTF8_sequence[256 + byte_count];
-
-                // Transition to the first state.
-                uint8_t state = unicorn_next_UTF8_DFA[unicorn_byte_to_character_class[curr[0]]];
-
-                // Consume the remaining bytes.
-                for (unisize i = 1; i < byte_count; i++)
-                {
-                    // Mask off the next byte.
-                    // It's of the form 10xxxxxx if valid UTF-8.
-                    const uint8_t mask = curr[i] & (uint8_t)0x3F;
-                    value = (value << UNICHAR_C(6)) | (unichar)mask;
-
-                    // Transition to the next DFA state.
-                    state = unicorn_next_UTF8_DFA[(const uint8_t)state + unicorn_byte_to_character_class[curr[i]]];
-                }
-
                 // Check for invalid UTF-8.
-                if (state == DFA_ACCEPTANCE_STATE)
+                unichar value;
+                if (u8_decode_sequence(curr, byte_count, &value) == DFA_ACCEPTANCE_STATE)
                 {
                     *offset += byte_count;
                     *scalar = value;
@@ -469,26 +554,9 @@ static unistat u8_prev(const void *text, unisize *offset, unichar *cp)
             curr = &curr[-byte_count];
             assert(curr >= start); // LCOV_EXCL_BR_LINE
 
-            // Consume the first byte.
-            unichar value = (unichar)curr[0] & (unichar)bytes_needed_for_UTF8_sequence[256 + byte_count];
-
-            // Transition to the first state.
-            uint8_t state = unicorn_next_UTF8_DFA[unicorn_byte_to_character_class[curr[0]]];
-
-            // Consume the remaining bytes.
-            for (unisize i = 1; i < byte_count; i++)
-            {
-                // Mask off the next byte.
-                // It's of the form 10xxxxxx if valid UTF-8.
-                const uint8_t mask = curr[i] & (uint8_t)0x3F;
-                value = (value << UNICHAR_C(6)) | (unichar)mask;
-
-                // Transition to the next DFA state.
-                state = unicorn_next_UTF8_DFA[(const uint8_t)state + unicorn_byte_to_character_class[curr[i]]];
-            }
-
             // Check for invalid UTF-8.
-            if (state == DFA_ACCEPTANCE_STATE)
+            unichar value;
+            if (u8_decode_sequence(curr, byte_count, &value) == DFA_ACCEPTANCE_STATE)
             {
                 *offset -= (unisize)byte_count;
                 *cp = value;
@@ -503,6 +571,152 @@ static unistat u8_prev(const void *text, unisize *offset, unichar *cp)
     return status;
 }
 
+// Returns the length of the maximal subpart of the ill-formed UTF-8 sequence at 'offset'.
+// This is the longest prefix of a well-formed sequence or one byte if there is none.
+// See "U+FFFD Substitution of Maximal Subparts" in chapter 3 of the Unicode Standard.
+static unisize u8_maximal_subpart(const unichar8 *bytes, unisize length, unisize offset)
+{
+    uint8_t state = DFA_ACCEPTANCE_STATE;
+    unisize count = 0;
+
+    // The null terminator is rejected by the DFA in the middle of a sequence.
+    while ((length < 0) || ((offset + count) < length))
+    {
+        state = u8_transition(state, bytes[offset + count]);
+        if (state == DFA_REJECTION_STATE)
+        {
+            break;
+        }
+        count += 1;
+        if (state == DFA_ACCEPTANCE_STATE)
+        {
+            break;
+        }
+    }
+
+    return (count == 0) ? 1 : count;
+}
+
+// Returns the length of the maximal subpart that ends at 'offset'. The subparts are
+// identical to those found when iterating forward so both directions agree.
+static unisize u8_maximal_subpart_before(const unichar8 *bytes, unisize offset)
+{
+    unisize count = 1;
+    unisize lead = offset - 1;
+
+    // Locate the nearest byte that is not a continuation byte within the length
+    // of the longest sequence. A subpart can only begin at such a byte.
+    while ((lead > 0) && ((offset - lead) < 4) && ((bytes[lead] & (uint8_t)0xC0) == (uint8_t)0x80))
+    {
+        lead -= 1;
+    }
+
+    // The continuation bytes are part of the subpart beginning at the lead byte only if
+    // it extends through all of them; otherwise the last byte is a subpart by itself.
+    if ((bytes[lead] & (uint8_t)0xC0) != (uint8_t)0x80)
+    {
+        if ((lead + u8_maximal_subpart(bytes, offset, lead)) == offset)
+        {
+            count = offset - lead;
+        }
+    }
+
+    return count;
+}
+
+static unistat u8_next_replace(const void *text, unisize text_length, unisize *offset, unichar *scalar)
+{
+    unistat status = u8_next(text, text_length, offset, scalar);
+    if (status == UNI_BAD_ENCODING)
+    {
+        *offset += u8_maximal_subpart(text, text_length, *offset);
+        *scalar = REPLACEMENT_CHARACTER;
+        status = UNI_OK;
+    }
+    return status;
+}
+
+// Advances the UTF-8 DFA from 'state' over the bytes and returns the final state.
+// Processing stops early if a byte is rejected. The offset of the first byte of the
+// sequence being decoded is tracked in 'start', which is negative if the sequence
+// began before 'bytes'.
+static uint8_t u8_validate_bytes(const unichar8 *bytes, unisize length, uint8_t state, unisize *start)
+{
+    uint8_t dfa = state;
+    unisize offset = 0;
+
+    // Validate the bulk of the text with a vectorized kernel (if available).
+    // It stops on a code point boundary at or before the first malformed sequence.
+    if (dfa == DFA_ACCEPTANCE_STATE)
+    {
+        offset = uni_kernels()->UTF8_valid_prefix(bytes, length);
+        *start = offset;
+    }
+
+    // Validate the remaining bytes with the DFA. Runs of ASCII characters are
+    // skipped eight bytes at a time whenever the DFA is between sequences.
+    while (offset < length)
+    {
+        bool is_ascii = false;
+        if (dfa == DFA_ACCEPTANCE_STATE)
+        {
+            *start = offset;
+            if ((length - offset) >= 8)
+            {
+                uint32_t words[2];
+                (void)memcpy(words, &bytes[offset], sizeof(words));
+                is_ascii = ((words[0] | words[1]) & UINT32_C(0x80808080)) == UINT32_C(0);
+            }
+        }
+
+        if (is_ascii)
+        {
+            offset += 8;
+        }
+        else
+        {
+            dfa = u8_transition(dfa, bytes[offset]);
+            if (dfa == DFA_REJECTION_STATE)
+            {
+                break;
+            }
+            offset += 1;
+        }
+    }
+
+    if (dfa == DFA_ACCEPTANCE_STATE)
+    {
+        *start = offset;
+    }
+
+    return dfa;
+}
+
+static unistat u8_validate(const void *text, unisize text_length)
+{
+    // LCOV_EXCL_START
+    assert(text != NULL);
+    // LCOV_EXCL_STOP
+
+    const unichar8 *bytes = text; // cppcheck-suppress misra-c2012-11.5
+    unisize length = text_length;
+    unisize start = 0;
+
+    // Locate the null terminator so the text can be processed in blocks.
+    if (length < 0)
+    {
+        length = 0;
+        while (bytes[length] != (uint8_t)0)
+        {
+            length += 1;
+        }
+    }
+
+    // The text must not end in the middle of a multi-byte sequence.
+    const uint8_t state = u8_validate_bytes(bytes, length, DFA_ACCEPTANCE_STATE, &start);
+    return (state == DFA_ACCEPTANCE_STATE) ? UNI_OK : UNI_BAD_ENCODING;
+}
+
 #endif
 
 #if defined(UNICORN_FEATURE_ENCODING_UTF16)
@@ -930,121 +1144,2026 @@ static unistat scalar_prev(const void *text, unisize *offset, unichar *scalar)
     return status;
 }
 
-UNICORN_API unistat uni_next(const void *text, unisize text_len, uniattr text_attr, unisize *index, unichar *cp)
+// Decodes the next character from the text. Each encoding form and byte order
+// has its own decoder so bulk decoding can be specialized per encoding form.
+typedef unistat (*DecodeNext)(const void *text, unisize text_length, unisize *offset, unichar *scalar);
+
+#if defined(UNICORN_FEATURE_ENCODING_UTF16)
+static unistat u16le_next(const void *text, unisize text_length, unisize *offset, unichar *scalar)
 {
-    ByteSwap16 swap16 = NULL;
-    ByteSwap32 swap32 = NULL;
-    unistat status = UNI_OK;
+    return u16_next(text, text_length, offset, scalar, &uni_swap16_le);
+}
 
-    if (index == NULL)
+static unistat u16be_next(const void *text, unisize text_length, unisize *offset, unichar *scalar)
+{
+    return u16_next(text, text_length, offset, scalar, &uni_swap16_be);
+}
+
+static unistat u16le_next_unsafe(const void *text, unisize text_length, unisize *offset, unichar *scalar)
+{
+    return u16_next_unsafe(text, text_length, offset, scalar, &uni_swap16_le);
+}
+
+static unistat u16be_next_unsafe(const void *text, unisize text_length, unisize *offset, unichar *scalar)
+{
+    return u16_next_unsafe(text, text_length, offset, scalar, &uni_swap16_be);
+}
+
+static unistat u16le_next_replace(const void *text, unisize text_length, unisize *offset, unichar *scalar)
+{
+    unistat status = u16le_next(text, text_length, offset, scalar);
+    if (status == UNI_BAD_ENCODING)
     {
-        uni_message("required argument 'index' is null");
-        status = UNI_BAD_OPERATION;
+        *offset += 1;
+        *scalar = REPLACEMENT_CHARACTER;
+        status = UNI_OK;
     }
-    else if (cp == NULL)
+    return status;
+}
+
+static unistat u16be_next_replace(const void *text, unisize text_length, unisize *offset, unichar *scalar)
+{
+    unistat status = u16be_next(text, text_length, offset, scalar);
+    if (status == UNI_BAD_ENCODING)
     {
-        uni_message("required argument 'cp' is null");
-        status = UNI_BAD_OPERATION;
+        *offset += 1;
+        *scalar = REPLACEMENT_CHARACTER;
+        status = UNI_OK;
     }
-    else
+    return status;
+}
+#endif
+
+#if defined(UNICORN_FEATURE_ENCODING_UTF32)
+static unistat u32le_next(const void *text, unisize text_length, unisize *offset, unichar *scalar)
+{
+    return u32_next(text, text_length, offset, scalar, &uni_swap32_le);
+}
+
+static unistat u32be_next(const void *text, unisize text_length, unisize *offset, unichar *scalar)
+{
+    return u32_next(text, text_length, offset, scalar, &uni_swap32_be);
+}
+
+static unistat u32le_next_unsafe(const void *text, unisize text_length, unisize *offset, unichar *scalar)
+{
+    return u32_next_unsafe(text, text_length, offset, scalar, &uni_swap32_le);
+}
+
+static unistat u32be_next_unsafe(const void *text, unisize text_length, unisize *offset, unichar *scalar)
+{
+    return u32_next_unsafe(text, text_length, offset, scalar, &uni_swap32_be);
+}
+
+static unistat u32le_next_replace(const void *text, unisize text_length, unisize *offset, unichar *scalar)
+{
+    unistat status = u32le_next(text, text_length, offset, scalar);
+    if (status == UNI_BAD_ENCODING)
     {
-        status = uni_check_input_encoding(text, text_len, &text_attr);
+        *offset += 1;
+        *scalar = REPLACEMENT_CHARACTER;
+        status = UNI_OK;
     }
+    return status;
+}
 
-    if (status == UNI_OK)
+static unistat u32be_next_replace(const void *text, unisize text_length, unisize *offset, unichar *scalar)
+{
+    unistat status = u32be_next(text, text_length, offset, scalar);
+    if (status == UNI_BAD_ENCODING)
     {
-        switch (GET_ENCODING(text_attr)) // LCOV_EXCL_BR_LINE
+        *offset += 1;
+        *scalar = REPLACEMENT_CHARACTER;
+        status = UNI_OK;
+    }
+    return status;
+}
+#endif
+
+static unistat scalar_next_replace(const void *text, unisize text_length, unisize *offset, unichar *scalar)
+{
+    unistat status = scalar_next(text, text_length, offset, scalar);
+    if (status == UNI_BAD_ENCODING)
+    {
+        *offset += 1;
+        *scalar = REPLACEMENT_CHARACTER;
+        status = UNI_OK;
+    }
+    return status;
+}
+
+#if defined(UNICORN_FEATURE_ENCODING_LATIN1)
+static unistat latin1_next(const void *text, unisize text_length, unisize *offset, unichar *scalar)
+{
+    return byte_next(text, text_length, offset, scalar, false);
+}
+#endif
+
+#if defined(UNICORN_FEATURE_ENCODING_CP1252)
+static unistat cp1252_next(const void *text, unisize text_length, unisize *offset, unichar *scalar)
+{
+    return byte_next(text, text_length, offset, scalar, true);
+}
+#endif
+
+// Decodes characters from the text into 'chars' until the end of the text is reached,
+// a malformed character is encountered, or 'chars' is full. If 'chars' is null, then
+// the characters are counted but not stored. This function is inlined into each caller
+// so the decoder is resolved at compile time rather than called through a pointer.
+// The 'byte_form' is the encoding form of text with 8-bit code units, which selects
+// the kernel for widening runs in bulk, or zero for all other encoding forms.
+static inline unistat decode_chars(const void *text, unisize text_length, DecodeNext next, uniattr byte_form, unichar *chars, unisize capacity, unisize *count, unisize *offset)
+{
+    // LCOV_EXCL_START
+    assert(text != NULL);
+    assert(count != NULL);
+    assert(offset != NULL);
+    // LCOV_EXCL_STOP
+
+    const struct Kernels *kernels = uni_kernels();
+    const unichar8 *bytes = text; // cppcheck-suppress misra-c2012-11.5
+    unistat status;
+    unisize n = *count;
+    unisize i = *offset;
+
+    for (;;)
+    {
+        // Widen runs of ASCII characters, or ISO-8859-1 characters, in bulk.
+        // This requires the length of the text to be known upfront.
+        if ((byte_form != (uniattr)0) && (chars != NULL) && (i < text_length))
         {
-        case UNI_UTF8:
-#if defined(UNICORN_FEATURE_ENCODING_UTF8)
-            if ((text_attr & UNI_TRUST) == UNI_TRUST)
+            const unisize available = ((text_length - i) < (capacity - n)) ? (text_length - i) : (capacity - n);
+            unisize widened = 0;
+            if (byte_form == UNI_LATIN1)
+            {
+                widened = kernels->LATIN1_widen(&bytes[i], available, &chars[n]);
+            }
+            else if (bytes[i] < (uint8_t)0x80)
             {
-                status = u8_next_unsafe(text, text_len, index, cp);
+                widened = kernels->ASCII_widen(&bytes[i], available, &chars[n]);
             }
             else
             {
-                status = u8_next(text, text_len, index, cp);
+                // No Action.
             }
-#else
-            uni_message("UTF-8 encoding form disabled");
-            status = UNI_FEATURE_DISABLED;
-#endif
+            i += widened;
+            n += widened;
+        }
+
+        unisize j = i;
+        unichar cp;
+        status = next(text, text_length, &j, &cp);
+        if (status != UNI_OK)
+        {
             break;
+        }
 
-        case UNI_UTF16:
+        if (chars != NULL)
+        {
+            if (n == capacity)
+            {
+                status = UNI_NO_SPACE;
+                break;
+            }
+            chars[n] = cp;
+        }
+
+        n += 1;
+        i = j;
+    }
+
+    *count = n;
+    *offset = i;
+    return status;
+}
+
+static unistat decode_text(const void *text, unisize text_length, uniattr text_attr, unichar *chars, unisize capacity, unisize *count, unisize *offset)
+{
+    const bool is_trusted = ((text_attr & UNI_TRUST) == UNI_TRUST) ? true : false;
+    const bool is_replacing = ((text_attr & UNI_REPLACE) == UNI_REPLACE) ? true : false;
+    unistat status;
+
+    switch (GET_ENCODING(text_attr)) // LCOV_EXCL_BR_LINE
+    {
+    case UNI_UTF8:
+#if defined(UNICORN_FEATURE_ENCODING_UTF8)
+        if (is_trusted)
+        {
+            status = decode_chars(text, text_length, &u8_next_unsafe, UNI_UTF8, chars, capacity, count, offset);
+        }
+        else if (is_replacing)
+        {
+            status = decode_chars(text, text_length, &u8_next_replace, UNI_UTF8, chars, capacity, count, offset);
+        }
+        else
+        {
+            status = decode_chars(text, text_length, &u8_next, UNI_UTF8, chars, capacity, count, offset);
+        }
+#else
+        uni_message("UTF-8 encoding form disabled");
+        status = UNI_FEATURE_DISABLED;
+#endif
+        break;
+
+    case UNI_UTF16:
 #if defined(UNICORN_FEATURE_ENCODING_UTF16)
-            swap16 = ((text_attr & UNI_LITTLE) == UNI_LITTLE) ? &uni_swap16_le : &uni_swap16_be;
-            if ((text_attr & UNI_TRUST) == UNI_TRUST)
+        if ((text_attr & UNI_LITTLE) == UNI_LITTLE)
+        {
+            if (is_trusted)
+            {
+                status = decode_chars(text, text_length, &u16le_next_unsafe, (uniattr)0, chars, capacity, count, offset);
+            }
+            else if (is_replacing)
+            {
+                status = decode_chars(text, text_length, &u16le_next_replace, (uniattr)0, chars, capacity, count, offset);
+            }
+            else
+            {
+                status = decode_chars(text, text_length, &u16le_next, (uniattr)0, chars, capacity, count, offset);
+            }
+        }
+        else
+        {
+            if (is_trusted)
+            {
+                status = decode_chars(text, text_length, &u16be_next_unsafe, (uniattr)0, chars, capacity, count, offset);
+            }
+            else if (is_replacing)
             {
-                status = u16_next_unsafe(text, text_len, index, cp, swap16);
+                status = decode_chars(text, text_length, &u16be_next_replace, (uniattr)0, chars, capacity, count, offset);
             }
             else
             {
-                status = u16_next(text, text_len, index, cp, swap16);
+                status = decode_chars(text, text_length, &u16be_next, (uniattr)0, chars, capacity, count, offset);
             }
+        }
 #else
-            uni_message("UTF-16 encoding form disabled");
-            status = UNI_FEATURE_DISABLED;
+        uni_message("UTF-16 encoding form disabled");
+        status = UNI_FEATURE_DISABLED;
 #endif
-            break;
+        break;
 
-        case UNI_UTF32:
+    case UNI_UTF32:
 #if defined(UNICORN_FEATURE_ENCODING_UTF32)
-            swap32 = ((text_attr & UNI_LITTLE) == UNI_LITTLE) ? &uni_swap32_le : &uni_swap32_be;
-            if ((text_attr & UNI_TRUST) == UNI_TRUST)
+        if ((text_attr & UNI_LITTLE) == UNI_LITTLE)
+        {
+            if (is_trusted)
+            {
+                status = decode_chars(text, text_length, &u32le_next_unsafe, (uniattr)0, chars, capacity, count, offset);
+            }
+            else if (is_replacing)
             {
-                status = u32_next_unsafe(text, text_len, index, cp, swap32);
+                status = decode_chars(text, text_length, &u32le_next_replace, (uniattr)0, chars, capacity, count, offset);
             }
             else
             {
-                status = u32_next(text, text_len, index, cp, swap32);
+                status = decode_chars(text, text_length, &u32le_next, (uniattr)0, chars, capacity, count, offset);
             }
-#else
-            uni_message("UTF-32 encoding form disabled");
-            status = UNI_FEATURE_DISABLED;
-#endif
-            break;
-
-        case UNI_SCALAR:
-            if ((text_attr & UNI_TRUST) == UNI_TRUST)
+        }
+        else
+        {
+            if (is_trusted)
+            {
+                status = decode_chars(text, text_length, &u32be_next_unsafe, (uniattr)0, chars, capacity, count, offset);
+            }
+            else if (is_replacing)
             {
-                status = scalar_next_unsafe(text, text_len, index, cp);
+                status = decode_chars(text, text_length, &u32be_next_replace, (uniattr)0, chars, capacity, count, offset);
             }
             else
             {
-                status = scalar_next(text, text_len, index, cp);
+                status = decode_chars(text, text_length, &u32be_next, (uniattr)0, chars, capacity, count, offset);
+            }
+        }
+#else
+        uni_message("UTF-32 encoding form disabled");
+        status = UNI_FEATURE_DISABLED;
+#endif
+        break;
+
+    case UNI_LATIN1:
+#if defined(UNICORN_FEATURE_ENCODING_LATIN1)
+        status = decode_chars(text, text_length, &latin1_next, UNI_LATIN1, chars, capacity, count, offset);
+#else
+        uni_message("ISO-8859-1 encoding disabled");
+        status = UNI_FEATURE_DISABLED;
+#endif
+        break;
+
+    case UNI_CP1252:
+#if defined(UNICORN_FEATURE_ENCODING_CP1252)
+        status = decode_chars(text, text_length, &cp1252_next, UNI_CP1252, chars, capacity, count, offset);
+#else
+        uni_message("Windows-1252 encoding disabled");
+        status = UNI_FEATURE_DISABLED;
+#endif
+        break;
+
+    case UNI_SCALAR:
+        if (is_trusted)
+        {
+            status = decode_chars(text, text_length, &scalar_next_unsafe, (uniattr)0, chars, capacity, count, offset);
+        }
+        else if (is_replacing)
+        {
+            status = decode_chars(text, text_length, &scalar_next_replace, (uniattr)0, chars, capacity, count, offset);
+        }
+        else
+        {
+            status = decode_chars(text, text_length, &scalar_next, (uniattr)0, chars, capacity, count, offset);
+        }
+        break;
+
+    // LCOV_EXCL_START: This code path is tested via feature configuration tests.
+    default:
+        UNREACHABLE; // cppcheck-suppress premium-misra-c-2012-17.3
+        status = UNI_MALFUNCTION;
+        break;
+    // LCOV_EXCL_STOP
+    }
+
+    return status;
+}
+
+unistat uni_nextchar(const void *text, unisize text_len, uniattr text_attr, unisize *index, unichar *cp)
+{
+    ByteSwap16 swap16 = NULL;
+    ByteSwap32 swap32 = NULL;
+    unistat status;
+
+    switch (GET_ENCODING(text_attr)) // LCOV_EXCL_BR_LINE
+    {
+    case UNI_UTF8:
+#if defined(UNICORN_FEATURE_ENCODING_UTF8)
+        if ((text_attr & UNI_TRUST) == UNI_TRUST)
+        {
+            status = u8_next_unsafe(text, text_len, index, cp);
+        }
+        else
+        {
+            status = u8_next(text, text_len, index, cp);
+        }
+#else
+        uni_message("UTF-8 encoding form disabled");
+        status = UNI_FEATURE_DISABLED;
+#endif
+        break;
+
+    case UNI_UTF16:
+#if defined(UNICORN_FEATURE_ENCODING_UTF16)
+        swap16 = ((text_attr & UNI_LITTLE) == UNI_LITTLE) ? &uni_swap16_le : &uni_swap16_be;
+        if ((text_attr & UNI_TRUST) == UNI_TRUST)
+        {
+            status = u16_next_unsafe(text, text_len, index, cp, swap16);
+        }
+        else
+        {
+            status = u16_next(text, text_len, index, cp, swap16);
+        }
+#else
+        uni_message("UTF-16 encoding form disabled");
+        status = UNI_FEATURE_DISABLED;
+#endif
+        break;
+
+    case UNI_UTF32:
+#if defined(UNICORN_FEATURE_ENCODING_UTF32)
+        swap32 = ((text_attr & UNI_LITTLE) == UNI_LITTLE) ? &uni_swap32_le : &uni_swap32_be;
+        if ((text_attr & UNI_TRUST) == UNI_TRUST)
+        {
+            status = u32_next_unsafe(text, text_len, index, cp, swap32);
+        }
+        else
+        {
+            status = u32_next(text, text_len, index, cp, swap32);
+        }
+#else
+        uni_message("UTF-32 encoding form disabled");
+        status = UNI_FEATURE_DISABLED;
+#endif
+        break;
+
+    case UNI_LATIN1:
+#if defined(UNICORN_FEATURE_ENCODING_LATIN1)
+        status = byte_next(text, text_len, index, cp, false);
+#else
+        uni_message("ISO-8859-1 encoding disabled");
+        status = UNI_FEATURE_DISABLED;
+#endif
+        break;
+
+    case UNI_CP1252:
+#if defined(UNICORN_FEATURE_ENCODING_CP1252)
+        status = byte_next(text, text_len, index, cp, true);
+#else
+        uni_message("Windows-1252 encoding disabled");
+        status = UNI_FEATURE_DISABLED;
+#endif
+        break;
+
+    case UNI_SCALAR:
+        if ((text_attr & UNI_TRUST) == UNI_TRUST)
+        {
+            status = scalar_next_unsafe(text, text_len, index, cp);
+        }
+        else
+        {
+            status = scalar_next(text, text_len, index, cp);
+        }
+        break;
+
+    // LCOV_EXCL_START: This code path is tested via feature configuration tests.
+    default:
+        UNREACHABLE; // cppcheck-suppress premium-misra-c-2012-17.3
+        status = UNI_MALFUNCTION;
+        break;
+    // LCOV_EXCL_STOP
+    }
+
+    // Substitute the replacement character for the maximal subpart of a malformed sequence.
+    if ((status == UNI_BAD_ENCODING) && ((text_attr & UNI_REPLACE) == UNI_REPLACE))
+    {
+#if defined(UNICORN_FEATURE_ENCODING_UTF8)
+        *index += (GET_ENCODING(text_attr) == UNI_UTF8) ? u8_maximal_subpart(text, text_len, *index) : 1;
+#else
+        *index += 1;
+#endif
+        *cp = REPLACEMENT_CHARACTER;
+        status = UNI_OK;
+    }
+
+    return status;
+}
+
+UNICORN_API unistat uni_next(const void *text, unisize text_len, uniattr text_attr, unisize *index, unichar *cp)
+{
+    unistat status = UNI_OK;
+
+    if (index == NULL)
+    {
+        uni_message("required argument 'index' is null");
+        status = UNI_BAD_OPERATION;
+    }
+    else if (cp == NULL)
+    {
+        uni_message("required argument 'cp' is null");
+        status = UNI_BAD_OPERATION;
+    }
+    else
+    {
+        status = uni_check_input_encoding(text, text_len, &text_attr);
+    }
+
+    if (status == UNI_OK)
+    {
+        status = uni_nextchar(text, text_len, text_attr, index, cp);
+    }
+    return status;
+}
+
+unistat uni_prevchar(const void *text, unisize text_len, uniattr text_attr, unisize *index, unichar *cp)
+{
+    ByteSwap16 swap16 = NULL;
+    ByteSwap32 swap32 = NULL;
+    unistat status;
+
+    // The 'length' parameter is unused in the implementation of decode previous.
+    // It is provided as part of the function signature so it matches the signature of decode next.
+    (void)text_len;
+
+    switch (GET_ENCODING(text_attr)) // LCOV_EXCL_BR_LINE
+    {
+    case UNI_UTF8:
+#if defined(UNICORN_FEATURE_ENCODING_UTF8)
+        if ((text_attr & UNI_TRUST) == UNI_TRUST)
+        {
+            status = u8_prev_unsafe(text, index, cp);
+        }
+        else
+        {
+            status = u8_prev(text, index, cp);
+        }
+#else
+        status = UNI_FEATURE_DISABLED;
+        uni_message("UTF-8 encoding form disabled");
+#endif
+        break;
+
+    case UNI_UTF16:
+#if defined(UNICORN_FEATURE_ENCODING_UTF16)
+        swap16 = ((text_attr & UNI_LITTLE) == UNI_LITTLE) ? &uni_swap16_le : &uni_swap16_be;
+        if ((text_attr & UNI_TRUST) == UNI_TRUST)
+        {
+            status = u16_prev_unsafe(text, index, cp, swap16);
+        }
+        else
+        {
+            status = u16_prev(text, index, cp, swap16);
+        }
+#else
+        status = UNI_FEATURE_DISABLED;
+        uni_message("UTF-16 encoding form disabled");
+#endif
+        break;
+
+    case UNI_UTF32:
+#if defined(UNICORN_FEATURE_ENCODING_UTF32)
+        swap32 = ((text_attr & UNI_LITTLE) == UNI_LITTLE) ? &uni_swap32_le : &uni_swap32_be;
+        if ((text_attr & UNI_TRUST) == UNI_TRUST)
+        {
+            status = u32_prev_unsafe(text, index, cp, swap32);
+        }
+        else
+        {
+            status = u32_prev(text, index, cp, swap32);
+        }
+#else
+        status = UNI_FEATURE_DISABLED;
+        uni_message("UTF-32 encoding form disabled");
+#endif
+        break;
+
+    case UNI_LATIN1:
+#if defined(UNICORN_FEATURE_ENCODING_LATIN1)
+        status = byte_prev(text, index, cp, false);
+#else
+        status = UNI_FEATURE_DISABLED;
+        uni_message("ISO-8859-1 encoding disabled");
+#endif
+        break;
+
+    case UNI_CP1252:
+#if defined(UNICORN_FEATURE_ENCODING_CP1252)
+        status = byte_prev(text, index, cp, true);
+#else
+        status = UNI_FEATURE_DISABLED;
+        uni_message("Windows-1252 encoding disabled");
+#endif
+        break;
+
+    case UNI_SCALAR:
+        if ((text_attr & UNI_TRUST) == UNI_TRUST)
+        {
+            status = scalar_prev_unsafe(text, index, cp);
+        }
+        else
+        {
+            status = scalar_prev(text, index, cp);
+        }
+        break;
+
+    // LCOV_EXCL_START: This code path is tested via feature configuration tests.
+    default:
+        UNREACHABLE; // cppcheck-suppress premium-misra-c-2012-17.3
+        status = UNI_MALFUNCTION;
+        break;
+    // LCOV_EXCL_STOP
+    }
+
+    // Substitute the replacement character for the maximal subpart of a malformed sequence.
+    if ((status == UNI_BAD_ENCODING) && ((text_attr & UNI_REPLACE) == UNI_REPLACE))
+    {
+#if defined(UNICORN_FEATURE_ENCODING_UTF8)
+        *index -= (GET_ENCODING(text_attr) == UNI_UTF8) ? u8_maximal_subpart_before(text, *index) : 1;
+#else
+        *index -= 1;
+#endif
+        *cp = REPLACEMENT_CHARACTER;
+        status = UNI_OK;
+    }
+
+    return status;
+}
+
+UNICORN_API unistat uni_prev(const void *text, unisize text_len, uniattr text_attr, unisize *index, unichar *cp)
+{
+    unistat status = UNI_OK;
+
+    if (index == NULL)
+    {
+        uni_message("required argument 'index' is null");
+        status = UNI_BAD_OPERATION;
+    }
+    else if (cp == NULL)
+    {
+        uni_message("required argument 'cp' is null");
+        status = UNI_BAD_OPERATION;
+    }
+    else
+    {
+        status = uni_check_input_encoding(text, text_len, &text_attr);
+    }
+
+    if (status == UNI_OK)
+    {
+        status = uni_prevchar(text, text_len, text_attr, index, cp);
+    }
+    return status;
+}
+
+UNICORN_API unistat uni_view(const void *text, unisize text_len, uniattr text_attr, uniview *view) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+{
+    unistat status = UNI_OK;
+
+    if (view == NULL)
+    {
+        uni_message("required argument 'view' is null");
+        status = UNI_BAD_OPERATION;
+    }
+    else
+    {
+        status = uni_check_input_encoding(text, text_len, &text_attr);
+    }
+
+    if (status == UNI_OK)
+    {
+        // The attributes are stored fully resolved so the view functions
+        // can skip checking them on every call.
+        view->text = text;
+        view->text_len = text_len;
+        view->text_attr = text_attr;
+    }
+
+    return status;
+}
+
+UNICORN_API unistat uni_viewnext(const uniview *view, unisize *index, unichar *cp) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+{
+    unistat status;
+
+    if ((view == NULL) || (index == NULL) || (cp == NULL))
+    {
+        uni_message("required argument is null");
+        status = UNI_BAD_OPERATION;
+    }
+    else
+    {
+        status = uni_nextchar(view->text, view->text_len, view->text_attr, index, cp);
+    }
+
+    return status;
+}
+
+UNICORN_API unistat uni_viewprev(const uniview *view, unisize *index, unichar *cp) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+{
+    unistat status;
+
+    if ((view == NULL) || (index == NULL) || (cp == NULL))
+    {
+        uni_message("required argument is null");
+        status = UNI_BAD_OPERATION;
+    }
+    else
+    {
+        status = uni_prevchar(view->text, view->text_len, view->text_attr, index, cp);
+    }
+
+    return status;
+}
+
+UNICORN_API unistat uni_encode(unichar cp, void *dst, unisize *dst_len, uniattr dst_attr) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+{
+    unistat status = UNI_OK;
+    struct CharBuf buffer = {NULL};
+
+    if (!is_valid_scalar(cp))
+    {
+        status = UNI_BAD_OPERATION;
+    }
+
+    if (status == UNI_OK)
+    {
+        status = uni_charbuf_init(&buffer, dst, dst_len, dst_attr);
+        if (status == UNI_OK)
+        {
+            uni_charbuf_appendchar(&buffer, cp);
+            status = uni_charbuf_finalize(&buffer);
+        }
+    }
+
+    return status;
+}
+
+#if defined(UNICORN_FEATURE_ENCODING_UTF8) && defined(UNICORN_FEATURE_ENCODING_UTF16)
+// Transcodes UTF-8 to UTF-16 writing directly to the buffer storage. The behavior is
+// identical to decoding and appending each character individually with the exception
+// that runs of well-formed characters are transcoded in bulk. Characters are decoded
+// individually where the bulk kernel stops: at ill-formed sequences, which are reported
+// or replaced, and at characters that don't fit the buffer.
+static inline unistat u8_to_u16(const void *text, unisize text_length, DecodeNext next, ByteSwap16 swap, bool is_big, struct CharBuf *buf)
+{
+    const struct Kernels *kernels = uni_kernels();
+    const unichar8 *bytes = text; // cppcheck-suppress misra-c2012-11.5
+    unistat status;
+    unisize i = 0;
+
+    for (;;)
+    {
+        // Bulk transcode well-formed text. This is only done while the buffer has
+        // space because once a character doesn't fit, nothing more is written.
+        // The storage is re-read because it moves when an allocated buffer grows.
+        unichar16 *words = buf->storage; // cppcheck-suppress misra-c2012-11.5
+        if ((words != NULL) && (i < text_length) && (buf->length == buf->written))
+        {
+            unisize count = 0;
+            const unisize consumed = kernels->UTF8_to_UTF16(&bytes[i], text_length - i, &words[buf->length], buf->capacity - buf->length, is_big, &count);
+            if (consumed > 0)
+            {
+                buf->length += count;
+                buf->written += count;
+                buf->is_null_terminated = (words[buf->length - 1] == (unichar16)0) ? true : false;
+                i += consumed;
+            }
+        }
+
+        unichar cp;
+        status = next(text, text_length, &i, &cp);
+        if (status != UNI_OK)
+        {
+            break;
+        }
+
+        unichar16 units[2];
+        const unisize units_count = unichar_to_u16(cp, units, swap);
+        uni_charbuf_reserve(buf, units_count);
+        words = buf->storage; // cppcheck-suppress misra-c2012-11.5
+        if ((words != NULL) && ((buf->length + units_count) <= buf->capacity))
+        {
+            (void)memcpy(&words[buf->length], units, sizeof(unichar16) * (size_t)units_count);
+            buf->written += units_count;
+        }
+        buf->length += units_count;
+        buf->is_null_terminated = (cp == UNICHAR_C(0)) ? true : false;
+    }
+
+    return status;
+}
+
+// Transcodes UTF-16 to UTF-8 writing directly to the buffer storage. The behavior is
+// identical to decoding and appending each character individually with the exception
+// that runs of well-formed characters are transcoded in bulk. Characters are decoded
+// individually where the bulk kernel stops: at unpaired surrogates, which are reported
+// or replaced, and at characters that don't fit the buffer.
+static inline unistat u16_to_u8(const void *text, unisize text_length, DecodeNext next, bool is_big, struct CharBuf *buf)
+{
+    const struct Kernels *kernels = uni_kernels();
+    const unichar16 *words = text; // cppcheck-suppress misra-c2012-11.5
+    unistat status;
+    unisize i = 0;
+
+    for (;;)
+    {
+        // Bulk transcode well-formed text. This is only done while the buffer has
+        // space because once a character doesn't fit, nothing more is written.
+        // The storage is re-read because it moves when an allocated buffer grows.
+        unichar8 *bytes = buf->storage; // cppcheck-suppress misra-c2012-11.5
+        if ((bytes != NULL) && (i < text_length) && (buf->length == buf->written))
+        {
+            unisize count = 0;
+            const unisize consumed = kernels->UTF16_to_UTF8(&words[i], text_length - i, &bytes[buf->length], buf->capacity - buf->length, is_big, &count);
+            if (consumed > 0)
+            {
+                buf->length += count;
+                buf->written += count;
+                buf->is_null_terminated = (bytes[buf->length - 1] == (uint8_t)0) ? true : false;
+                i += consumed;
+            }
+        }
+
+        unichar cp;
+        status = next(text, text_length, &i, &cp);
+        if (status != UNI_OK)
+        {
+            break;
+        }
+
+        unichar8 units[4];
+        const unisize units_count = unichar_to_u8(cp, units);
+        uni_charbuf_reserve(buf, units_count);
+        bytes = buf->storage; // cppcheck-suppress misra-c2012-11.5
+        if ((bytes != NULL) && ((buf->length + units_count) <= buf->capacity))
+        {
+            (void)memcpy(&bytes[buf->length], units, (size_t)units_count);
+            buf->written += units_count;
+        }
+        buf->length += units_count;
+        buf->is_null_terminated = (cp == UNICHAR_C(0)) ? true : false;
+    }
+
+    return status;
+}
+
+// Transcodes between UTF-8 and UTF-16 with a dedicated routine for each
+// combination of byte order and trust so the per character work is inlined.
+static unistat transcode_u8_u16(const void *text, unisize text_length, uniattr text_attr, struct CharBuf *buf)
+{
+    const bool is_trusted = ((text_attr & UNI_TRUST) == UNI_TRUST) ? true : false;
+    const bool is_replacing = ((text_attr & UNI_REPLACE) == UNI_REPLACE) ? true : false;
+    unistat status;
+
+    if (GET_ENCODING(text_attr) == UNI_UTF8)
+    {
+        if ((buf->encoding & UNI_BIG) == UNI_BIG)
+        {
+            if (is_trusted)
+            {
+                status = u8_to_u16(text, text_length, &u8_next_unsafe, &uni_swap16_be, true, buf);
+            }
+            else if (is_replacing)
+            {
+                status = u8_to_u16(text, text_length, &u8_next_replace, &uni_swap16_be, true, buf);
+            }
+            else
+            {
+                status = u8_to_u16(text, text_length, &u8_next, &uni_swap16_be, true, buf);
+            }
+        }
+        else
+        {
+            if (is_trusted)
+            {
+                status = u8_to_u16(text, text_length, &u8_next_unsafe, &uni_swap16_le, false, buf);
+            }
+            else if (is_replacing)
+            {
+                status = u8_to_u16(text, text_length, &u8_next_replace, &uni_swap16_le, false, buf);
+            }
+            else
+            {
+                status = u8_to_u16(text, text_length, &u8_next, &uni_swap16_le, false, buf);
+            }
+        }
+    }
+    else
+    {
+        if ((text_attr & UNI_BIG) == UNI_BIG)
+        {
+            if (is_trusted)
+            {
+                status = u16_to_u8(text, text_length, &u16be_next_unsafe, true, buf);
+            }
+            else if (is_replacing)
+            {
+                status = u16_to_u8(text, text_length, &u16be_next_replace, true, buf);
+            }
+            else
+            {
+                status = u16_to_u8(text, text_length, &u16be_next, true, buf);
+            }
+        }
+        else
+        {
+            if (is_trusted)
+            {
+                status = u16_to_u8(text, text_length, &u16le_next_unsafe, false, buf);
+            }
+            else if (is_replacing)
+            {
+                status = u16_to_u8(text, text_length, &u16le_next_replace, false, buf);
+            }
+            else
+            {
+                status = u16_to_u8(text, text_length, &u16le_next, false, buf);
+            }
+        }
+    }
+
+    return status;
+}
+#endif
+
+// Returns true if the code units of the encoding form are stored in big endian byte order.
+// Unicode scalar values are always stored in the native byte order.
+static bool is_big_endian(uniattr attr)
+{
+    bool is_big;
+    if (GET_ENCODING(attr) == UNI_SCALAR)
+    {
+#if defined(UNICORN_BIG_ENDIAN)
+        is_big = true;
+#else
+        is_big = false;
+#endif
+    }
+    else
+    {
+        is_big = ((attr & UNI_BIG) == UNI_BIG) ? true : false;
+    }
+    return is_big;
+}
+
+// Copies the text to a buffer whose code units are the same size as the text, possibly
+// with the opposite byte order. The behavior is identical to decoding and appending each
+// character individually with the exception that well-formed runs of code units are
+// validated, byte swapped, and copied in bulk.
+static unistat copy_text(const void *text, unisize text_length, uniattr text_attr, struct CharBuf *buf)
+{
+    const struct Kernels *kernels = uni_kernels();
+    const bool is_big = is_big_endian(text_attr);
+    const bool swap = (is_big != is_big_endian(buf->encoding)) ? true : false;
+    unistat status;
+    unisize i = 0;
+
+    for (;;)
+    {
+        // Bulk copy well-formed code units. This is only done while the buffer
+        // has space because once a character doesn't fit, nothing more is written.
+        if ((buf->storage != NULL) && (i < text_length) && (buf->length == buf->written))
+        {
+            const unisize available = ((text_length - i) < (buf->capacity - buf->length)) ? (text_length - i) : (buf->capacity - buf->length);
+            unisize count;
+            bool is_null;
+
+            switch (GET_ENCODING(text_attr)) // LCOV_EXCL_BR_LINE
+            {
+            case UNI_UTF8:
+            {
+                const unichar8 *bytes = text; // cppcheck-suppress misra-c2012-11.5
+                unichar8 *storage = buf->storage; // cppcheck-suppress misra-c2012-11.5
+                count = kernels->UTF8_valid_prefix(&bytes[i], available);
+                (void)memcpy(&storage[buf->length], &bytes[i], (size_t)count);
+                is_null = (count > 0) && (bytes[i + count - 1] == (unichar8)0);
+                break;
+            }
+
+            case UNI_UTF16:
+            {
+                const unichar16 *words = text; // cppcheck-suppress misra-c2012-11.5
+                unichar16 *storage = buf->storage; // cppcheck-suppress misra-c2012-11.5
+                count = kernels->UTF16_copy(&words[i], available, &storage[buf->length], is_big, swap);
+                is_null = (count > 0) && (words[i + count - 1] == (unichar16)0);
+                break;
+            }
+
+            default:
+            {
+                const unichar32 *chars = text; // cppcheck-suppress misra-c2012-11.5
+                unichar32 *storage = buf->storage; // cppcheck-suppress misra-c2012-11.5
+                count = kernels->UTF32_copy(&chars[i], available, &storage[buf->length], is_big, swap);
+                is_null = (count > 0) && (chars[i + count - 1] == (unichar32)0);
+                break;
+            }
+            }
+
+            if (count > 0)
+            {
+                buf->length += count;
+                buf->written += count;
+                buf->is_null_terminated = is_null;
+                i += count;
+            }
+        }
+
+        unichar cp;
+        status = uni_nextchar(text, text_length, text_attr, &i, &cp);
+        if (status != UNI_OK)
+        {
+            break;
+        }
+        uni_charbuf_appendchar(buf, cp);
+    }
+
+    return status;
+}
+
+// Returns the size, in bytes, of the code units of the encoding form.
+static size_t code_unit_size(uniattr attr)
+{
+    size_t size;
+    switch (GET_ENCODING(attr))
+    {
+    case UNI_UTF8:
+    case UNI_LATIN1:
+    case UNI_CP1252:
+        size = sizeof(unichar8);
+        break;
+    case UNI_UTF16:
+        size = sizeof(unichar16);
+        break;
+    default:
+        size = sizeof(unichar32);
+        break;
+    }
+    return size;
+}
+
+#if defined(UNICORN_FEATURE_ENCODING_LATIN1) || defined(UNICORN_FEATURE_ENCODING_CP1252)
+// Transcodes the leading run of characters, beginning at code unit 'index' of the text, that
+// can be transcoded in bulk where either the text or the buffer is ISO-8859-1 or Windows-1252.
+// At most 'available' code units are read from the text and at most 'capacity' code units are
+// written to the buffer. The number of code units written is stored in 'written' and whether
+// the last character transcoded is a null character is stored in 'is_null'. Returns the number
+// of code units transcoded from the text.
+static unisize transcode_bytes_run(const void *text, uniattr text_attr, unisize index, unisize available, struct CharBuf *buf, unisize capacity, unisize *written, bool *is_null)
+{
+    const struct Kernels *kernels = uni_kernels();
+    const uniattr src_form = GET_ENCODING(text_attr);
+    const uniattr dst_form = GET_ENCODING(buf->encoding);
+    const unisize limit = (available < capacity) ? available : capacity;
+    unisize count = 0;
+
+    // Characters map one-to-one between the code units of the text and the buffer
+    // except when transcoding between UTF-8 and a single byte encoding.
+    *written = 0;
+
+    if ((src_form & (UNI_LATIN1 | UNI_CP1252)) != (uniattr)0)
+    {
+        const unichar8 *bytes = text; // cppcheck-suppress misra-c2012-11.5
+        bytes = &bytes[index];
+
+        if (src_form == dst_form)
+        {
+            unichar8 *storage = buf->storage; // cppcheck-suppress misra-c2012-11.5
+            (void)memcpy(&storage[buf->length], bytes, (size_t)limit);
+            count = limit;
+        }
+        else if (dst_form == UNI_UTF8)
+        {
+            unichar8 *storage = buf->storage; // cppcheck-suppress misra-c2012-11.5
+            count = kernels->LATIN1_to_UTF8(bytes, available, &storage[buf->length], capacity, written);
+        }
+        else if ((dst_form & (UNI_LATIN1 | UNI_CP1252)) != (uniattr)0)
+        {
+            // Only ASCII is encoded identically in both encodings.
+            unichar8 *storage = buf->storage; // cppcheck-suppress misra-c2012-11.5
+            count = kernels->ASCII_prefix(bytes, limit);
+            (void)memcpy(&storage[buf->length], bytes, (size_t)count);
+        }
+        else if (dst_form == UNI_UTF16)
+        {
+            unichar16 *storage = buf->storage; // cppcheck-suppress misra-c2012-11.5
+            if (src_form == UNI_LATIN1)
+            {
+                count = kernels->LATIN1_to_UTF16(bytes, limit, &storage[buf->length], is_big_endian(buf->encoding));
+            }
+            else
+            {
+                count = kernels->ASCII_to_UTF16(bytes, limit, &storage[buf->length], is_big_endian(buf->encoding));
+            }
+        }
+        else if (is_big_endian(buf->encoding) == is_big_endian(UNI_SCALAR))
+        {
+            // UTF-32 in native byte order is identical to scalar values.
+            unichar *storage = buf->storage; // cppcheck-suppress misra-c2012-11.5
+            if (src_form == UNI_LATIN1)
+            {
+                count = kernels->LATIN1_widen(bytes, limit, &storage[buf->length]);
+            }
+            else
+            {
+                count = kernels->ASCII_widen(bytes, limit, &storage[buf->length]);
+            }
+        }
+        else
+        {
+            // No Action.
+        }
+
+        if (dst_form != UNI_UTF8)
+        {
+            *written = count;
+        }
+        *is_null = (count > 0) && (bytes[count - 1] == (unichar8)0);
+    }
+    else if (src_form == UNI_UTF8)
+    {
+        const unichar8 *bytes = text; // cppcheck-suppress misra-c2012-11.5
+        unichar8 *storage = buf->storage; // cppcheck-suppress misra-c2012-11.5
+        bytes = &bytes[index];
+
+        // The transcoded text is never longer than the UTF-8 text.
+        *written = kernels->UTF8_to_LATIN1(bytes, limit, &storage[buf->length], &count);
+        *is_null = (count > 0) && (bytes[count - 1] == (unichar8)0);
+    }
+    else if (src_form == UNI_UTF16)
+    {
+        const unichar16 *words = text; // cppcheck-suppress misra-c2012-11.5
+        unichar8 *storage = buf->storage; // cppcheck-suppress misra-c2012-11.5
+        words = &words[index];
+        if (dst_form == UNI_LATIN1)
+        {
+            count = kernels->UTF16_to_LATIN1(words, limit, &storage[buf->length], is_big_endian(text_attr));
+        }
+        else
+        {
+            count = kernels->UTF16_to_ASCII(words, limit, &storage[buf->length], is_big_endian(text_attr));
+        }
+        *written = count;
+        *is_null = (count > 0) && (words[count - 1] == (unichar16)0);
+    }
+    else
+    {
+        // No Action.
+    }
+
+    return count;
+}
+
+// Transcodes text from or to ISO-8859-1 or Windows-1252. The behavior is identical to decoding
+// and appending each character individually with the exception that runs of characters that
+// the kernels understand are transcoded in bulk. This avoids widening the text to scalar values
+// or converting it to an intermediate UTF-8 copy.
+static unistat transcode_bytes(const void *text, unisize text_length, uniattr text_attr, struct CharBuf *buf)
+{
+    unistat status;
+    unisize i = 0;
+
+    for (;;)
+    {
+        // Bulk transcode runs of characters. This is only done while the buffer
+        // has space because once a character doesn't fit, nothing more is written.
+        if ((buf->storage != NULL) && (i < text_length) && (buf->length == buf->written))
+        {
+            unisize written = 0;
+            bool is_null = false;
+            const unisize count = transcode_bytes_run(text, text_attr, i, text_length - i, buf, buf->capacity - buf->length, &written, &is_null);
+            if (count > 0)
+            {
+                buf->length += written;
+                buf->written += written;
+                buf->is_null_terminated = is_null;
+                i += count;
+            }
+        }
+
+        unichar cp;
+        status = uni_nextchar(text, text_length, text_attr, &i, &cp);
+        if (status != UNI_OK)
+        {
+            break;
+        }
+        uni_charbuf_appendchar(buf, cp);
+    }
+
+    return status;
+}
+#endif
+
+// Converts the text to the encoding form of the buffer.
+// Converts the text one character at a time recording each character as a position the
+// output can resume from. Conversion starts from where the previous call stopped.
+static unistat convert_resumable(const void *text, unisize text_length, uniattr text_attr, struct CharBuf *buf)
+{
+    unistat status;
+    unisize i = uni_charbuf_resume(buf, NULL);
+
+    for (;;)
+    {
+        if (uni_charbuf_checkpoint(buf, i, 0))
+        {
+            status = UNI_DONE;
+            break;
+        }
+
+        unichar cp;
+        status = uni_nextchar(text, text_length, text_attr, &i, &cp);
+        if (status == UNI_OK)
+        {
+            uni_charbuf_appendchar(buf, cp);
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    return status;
+}
+
+// Converts scalar values to the encoding form of the buffer. Runs of valid scalar values are
+// appended in one batch so the buffer checks its capacity once per run rather than per character.
+// The character that ends a run is decoded individually so it's rejected or replaced as the text
+// attributes dictate.
+static unistat convert_scalars(const void *text, unisize text_length, uniattr text_attr, struct CharBuf *buf)
+{
+    const unichar *chars = text; // cppcheck-suppress misra-c2012-11.5
+    unistat status;
+    unisize i = 0;
+
+    for (;;)
+    {
+        unisize run = i;
+        while ((run < text_length) && is_valid_scalar(chars[run]))
+        {
+            run += 1;
+        }
+
+        if (run > i)
+        {
+            uni_charbuf_append(buf, &chars[i], run - i);
+            i = run;
+        }
+
+        unichar cp;
+        status = uni_nextchar(text, text_length, text_attr, &i, &cp);
+        if (status != UNI_OK)
+        {
+            break;
+        }
+        uni_charbuf_appendchar(buf, cp);
+    }
+
+    return status;
+}
+
+static unistat convert_text(const void *text, unisize text_length, uniattr text_attr, struct CharBuf *buf)
+{
+    unistat status;
+
+    // The bulk conversion routines don't track positions in the source text
+    // therefore resumable output is converted character by character.
+    if (buf->cursor != NULL)
+    {
+        status = convert_resumable(text, text_length, text_attr, buf);
+    }
+    else
+#if defined(UNICORN_FEATURE_ENCODING_LATIN1) || defined(UNICORN_FEATURE_ENCODING_CP1252)
+    // Check if either encoding form is a single byte encoding.
+    if (((GET_ENCODING(text_attr) | GET_ENCODING(buf->encoding)) & (UNI_LATIN1 | UNI_CP1252)) != (uniattr)0)
+    {
+        status = transcode_bytes(text, text_length, text_attr, buf);
+    }
+    else
+#endif
+#if defined(UNICORN_FEATURE_ENCODING_UTF8) && defined(UNICORN_FEATURE_ENCODING_UTF16)
+    // Check if one encoding form is UTF-8 and the other is UTF-16.
+    if ((GET_ENCODING(text_attr) | GET_ENCODING(buf->encoding)) == (UNI_UTF8 | UNI_UTF16))
+    {
+        status = transcode_u8_u16(text, text_length, text_attr, buf);
+    }
+    else
+#endif
+    if (code_unit_size(text_attr) == code_unit_size(buf->encoding))
+    {
+        status = copy_text(text, text_length, text_attr, buf);
+    }
+    else if ((GET_ENCODING(text_attr) == UNI_SCALAR) && (text_length >= 0))
+    {
+        status = convert_scalars(text, text_length, text_attr, buf);
+    }
+    else
+    {
+        unisize i = 0;
+        for (;;)
+        {
+            unichar cp;
+            status = uni_nextchar(text, text_length, text_attr, &i, &cp);
+            if (status == UNI_OK)
+            {
+                uni_charbuf_appendchar(buf, cp);
+            }
+            else
+            {
+                break;
+            }
+        }
+    }
+
+    return status;
+}
+
+void uni_charbuf_append_text(struct CharBuf *buf, const void *text, unisize start, unisize end, uniattr text_attr)
+{
+    const unichar8 *bytes = text; // cppcheck-suppress misra-c2012-11.5
+    const unistat status = convert_text(&bytes[code_unit_size(text_attr) * (size_t)start], end - start, text_attr, buf);
+    assert(status == UNI_DONE); // LCOV_EXCL_BR_LINE
+    (void)status;
+}
+
+UNICORN_API unistat uni_convert(const void *src, unisize src_len, uniattr src_attr, void *dst, unisize *dst_len, uniattr dst_attr) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+{
+    unistat status = UNI_OK;
+
+    if (src == NULL)
+    {
+        uni_message("required argument is null");
+        status = UNI_BAD_OPERATION;
+    }
+
+    if (status == UNI_OK)
+    {
+        status = uni_check_input_encoding(src, src_len, &src_attr);
+    }
+
+    if (status == UNI_OK)
+    {
+        struct CharBuf buffer = {NULL};
+        status = uni_charbuf_init(&buffer, dst, dst_len, dst_attr);
+        if (status == UNI_OK)
+        {
+            status = convert_text(src, src_len, src_attr, &buffer);
+            if (status == UNI_DONE)
+            {
+                status = uni_charbuf_finalize(&buffer);
+            }
+        }
+    }
+
+    return status;
+}
+
+UNICORN_API unistat uni_decode(const void *src, unisize src_len, uniattr src_attr, unichar *dst, unisize *dst_len, unisize *consumed) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+{
+    unistat status = UNI_OK;
+    uniattr dst_attr = UNI_SCALAR;
+
+    if (src == NULL)
+    {
+        uni_message("required argument is null");
+        status = UNI_BAD_OPERATION;
+    }
+
+    if (status == UNI_OK)
+    {
+        status = uni_check_input_encoding(src, src_len, &src_attr);
+    }
+
+    if (status == UNI_OK)
+    {
+        status = uni_check_output_encoding(dst, dst_len, &dst_attr);
+    }
+
+    if (status == UNI_OK)
+    {
+        unisize count = 0;
+        unisize offset = 0;
+        status = decode_text(src, src_len, src_attr, dst, *dst_len, &count, &offset);
+        if (status == UNI_DONE)
+        {
+            status = UNI_OK;
+        }
+
+        if (status != UNI_FEATURE_DISABLED)
+        {
+            *dst_len = count;
+            if (consumed != NULL)
+            {
+                *consumed = offset;
+            }
+        }
+    }
+
+    return status;
+}
+
+// Verifies the text is well-formed.
+static unistat validate_text(const void *text, unisize text_length, uniattr text_attr)
+{
+    unistat status;
+
+#if defined(UNICORN_FEATURE_ENCODING_UTF8)
+    if (GET_ENCODING(text_attr) == UNI_UTF8)
+    {
+        status = u8_validate(text, text_length);
+    }
+    else
+#endif
+    {
+        unisize i = 0;
+        for (;;)
+        {
+            unichar cp;
+            status = uni_nextchar(text, text_length, text_attr, &i, &cp);
+            if (status != UNI_OK)
+            {
+                break;
+            }
+        }
+
+        if (status == UNI_DONE)
+        {
+            status = UNI_OK;
+        }
+    }
+
+    return status;
+}
+
+UNICORN_API unistat uni_validate(const void *text, unisize text_len, uniattr text_attr) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+{
+    unistat status = UNI_OK;
+
+    if (text == NULL)
+    {
+        uni_message("required argument is null");
+        status = UNI_BAD_OPERATION;
+    }
+
+    if (status == UNI_OK)
+    {
+        status = uni_check_input_encoding(text, text_len, &text_attr);
+    }
+
+    if (status == UNI_OK)
+    {
+        // The 'trust' flag is useless for this function because its entire
+        // purpose is to verify that the input text is well-formed therefore
+        // assuming it is well formed via the 'trust' flag defeats this purpose.
+        if ((text_attr & UNI_TRUST) == UNI_TRUST)
+        {
+            uni_message("trust flag is self-defeating");
+            status = UNI_BAD_OPERATION;
+        }
+        else if ((text_attr & UNI_REPLACE) == UNI_REPLACE)
+        {
+            uni_message("replace flag is self-defeating");
+            status = UNI_BAD_OPERATION;
+        }
+        else
+        {
+            // No Action.
+        }
+    }
+
+    if (status == UNI_OK)
+    {
+        status = validate_text(text, text_len, text_attr);
+    }
+    return status;
+}
+
+#if defined(UNICORN_FEATURE_ENCODING_UTF16)
+// Validates a chunk of UTF-16 text. The validator state is non-zero while a high
+// surrogate is waiting for its low surrogate, which may arrive in the next chunk.
+static unistat u16_validate_chunk(univalidator *validator, const unichar16 *words, unisize length, ByteSwap16 swap)
+{
+    unistat status = UNI_OK;
+
+    for (unisize i = 0; i < length; i++)
+    {
+        const unichar word = (unichar)swap(words[i]);
+        if (validator->state != 0u)
+        {
+            if (is_low_surrogate(word))
+            {
+                validator->state = 0u;
+            }
+            else
+            {
+                status = UNI_BAD_ENCODING; // Unpaired high surrogate.
+                break;
+            }
+        }
+        else if (is_high_surrogate(word))
+        {
+            validator->state = 1u;
+            validator->start = validator->offset + i;
+        }
+        else if (is_low_surrogate(word))
+        {
+            validator->start = validator->offset + i;
+            status = UNI_BAD_ENCODING; // Unpaired low surrogate.
+            break;
+        }
+        else
+        {
+            // No Action.
+        }
+    }
+
+    return status;
+}
+#endif
+
+#if defined(UNICORN_FEATURE_ENCODING_UTF32)
+static unistat u32_validate_chunk(univalidator *validator, const unichar32 *chars, unisize length, ByteSwap32 swap)
+{
+    unistat status = UNI_OK;
+
+    for (unisize i = 0; i < length; i++)
+    {
+        if (!is_valid_scalar(swap(chars[i])))
+        {
+            validator->start = validator->offset + i;
+            status = UNI_BAD_ENCODING;
+            break;
+        }
+    }
+
+    return status;
+}
+#endif
+
+static unistat validate_chunk(univalidator *validator, const void *text, unisize length)
+{
+    unistat status = UNI_OK;
+    const uniattr text_attr = validator->text_attr;
+
+    switch (GET_ENCODING(text_attr)) // LCOV_EXCL_BR_LINE
+    {
+    case UNI_UTF8:
+#if defined(UNICORN_FEATURE_ENCODING_UTF8)
+        {
+            // The start of the sequence is tracked relative to this chunk.
+            unisize start = validator->start - validator->offset;
+            const uint8_t state = u8_validate_bytes(text, length, (uint8_t)validator->state, &start);
+            validator->state = state;
+            validator->start = validator->offset + start;
+            if (state == DFA_REJECTION_STATE)
+            {
+                status = UNI_BAD_ENCODING;
+            }
+        }
+#endif
+        break;
+
+    case UNI_UTF16:
+#if defined(UNICORN_FEATURE_ENCODING_UTF16)
+        status = u16_validate_chunk(validator, text, length, ((text_attr & UNI_LITTLE) == UNI_LITTLE) ? &uni_swap16_le : &uni_swap16_be);
+#endif
+        break;
+
+    case UNI_UTF32:
+#if defined(UNICORN_FEATURE_ENCODING_UTF32)
+        status = u32_validate_chunk(validator, text, length, ((text_attr & UNI_LITTLE) == UNI_LITTLE) ? &uni_swap32_le : &uni_swap32_be);
+#endif
+        break;
+
+    case UNI_LATIN1:
+    case UNI_CP1252:
+        break; // Every byte is a character therefore the text is always well-formed.
+
+    case UNI_SCALAR:
+        {
+            const unichar *chars = text; // cppcheck-suppress misra-c2012-11.5
+            for (unisize i = 0; i < length; i++)
+            {
+                if (!is_valid_scalar(chars[i]))
+                {
+                    validator->start = validator->offset + i;
+                    status = UNI_BAD_ENCODING;
+                    break;
+                }
+            }
+        }
+        break;
+
+    // LCOV_EXCL_START: This code path is tested via feature configuration tests.
+    default:
+        UNREACHABLE; // cppcheck-suppress premium-misra-c-2012-17.3
+        status = UNI_MALFUNCTION;
+        break;
+    // LCOV_EXCL_STOP
+    }
+
+    return status;
+}
+
+static unisize code_units_length(const void *text, unisize text_len, uniattr text_attr)
+{
+    unisize length = text_len;
+
+    // Locate the null terminator so the text can be processed in blocks.
+    if (length < 0)
+    {
+        const unichar8 *bytes = text; // cppcheck-suppress misra-c2012-11.5
+        const unichar16 *words = text; // cppcheck-suppress misra-c2012-11.5
+        const unichar32 *chars = text; // cppcheck-suppress misra-c2012-11.5
+
+        length = 0;
+        switch (GET_ENCODING(text_attr)) // LCOV_EXCL_BR_LINE
+        {
+        case UNI_UTF8:
+        case UNI_LATIN1:
+        case UNI_CP1252:
+            while (bytes[length] != (unichar8)0)
+            {
+                length += 1;
+            }
+            break;
+
+        case UNI_UTF16:
+            while (words[length] != (unichar16)0)
+            {
+                length += 1;
+            }
+            break;
+
+        default:
+            while (chars[length] != (unichar32)0)
+            {
+                length += 1;
+            }
+            break;
+        }
+    }
+
+    return length;
+}
+
+UNICORN_API unistat uni_validateinit(univalidator *validator, uniattr text_attr) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+{
+    unistat status = UNI_OK;
+    uniattr attr = text_attr;
+
+    if (validator == NULL)
+    {
+        uni_message("required argument 'validator' is null");
+        status = UNI_BAD_OPERATION;
+    }
+    else if ((attr & UNI_NULIFY) == UNI_NULIFY)
+    {
+        uni_message("input buffer incompatible with 'UNI_NULIFY' flag");
+        status = UNI_BAD_OPERATION;
+    }
+    else if ((attr & UNI_TRUST) == UNI_TRUST)
+    {
+        uni_message("trust flag is self-defeating");
+        status = UNI_BAD_OPERATION;
+    }
+    else if ((attr & UNI_REPLACE) == UNI_REPLACE)
+    {
+        uni_message("replace flag is self-defeating");
+        status = UNI_BAD_OPERATION;
+    }
+    else
+    {
+        status = uni_check_encoding(&attr);
+    }
+
+    if (status == UNI_OK)
+    {
+        switch (GET_ENCODING(attr))
+        {
+#if !defined(UNICORN_FEATURE_ENCODING_UTF8)
+        case UNI_UTF8:
+            uni_message("UTF-8 encoding form disabled");
+            status = UNI_FEATURE_DISABLED;
+            break;
+#endif
+#if !defined(UNICORN_FEATURE_ENCODING_UTF16)
+        case UNI_UTF16:
+            uni_message("UTF-16 encoding form disabled");
+            status = UNI_FEATURE_DISABLED;
+            break;
+#endif
+#if !defined(UNICORN_FEATURE_ENCODING_UTF32)
+        case UNI_UTF32:
+            uni_message("UTF-32 encoding form disabled");
+            status = UNI_FEATURE_DISABLED;
+            break;
+#endif
+#if !defined(UNICORN_FEATURE_ENCODING_LATIN1)
+        case UNI_LATIN1:
+            uni_message("ISO-8859-1 encoding disabled");
+            status = UNI_FEATURE_DISABLED;
+            break;
+#endif
+#if !defined(UNICORN_FEATURE_ENCODING_CP1252)
+        case UNI_CP1252:
+            uni_message("Windows-1252 encoding disabled");
+            status = UNI_FEATURE_DISABLED;
+            break;
+#endif
+        default:
+            break;
+        }
+    }
+
+    if (status == UNI_OK)
+    {
+        validator->text_attr = attr;
+        validator->offset = 0;
+        validator->start = 0;
+        validator->state = 0u; // The DFA acceptance state or no pending surrogate.
+        validator->status = UNI_OK;
+    }
+
+    return status;
+}
+
+UNICORN_API unistat uni_validatefeed(univalidator *validator, const void *text, unisize text_len, unisize *offset) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+{
+    unistat status = UNI_OK;
+
+    if (validator == NULL)
+    {
+        uni_message("required argument 'validator' is null");
+        status = UNI_BAD_OPERATION;
+    }
+    else if (text == NULL)
+    {
+        uni_message("input buffer is null");
+        status = UNI_BAD_OPERATION;
+    }
+    else
+    {
+        // Once an error is detected the validator remains in the error state.
+        status = validator->status;
+    }
+
+    if (status == UNI_OK)
+    {
+        const unisize length = code_units_length(text, text_len, validator->text_attr);
+        if (length > (INT32_MAX - validator->offset))
+        {
+            uni_message("stream too long");
+            status = UNI_BAD_OPERATION;
+        }
+        else
+        {
+            status = validate_chunk(validator, text, length);
+            validator->offset += length;
+            validator->status = status;
+        }
+    }
+
+    if ((status == UNI_BAD_ENCODING) && (offset != NULL))
+    {
+        *offset = validator->start;
+    }
+
+    return status;
+}
+
+UNICORN_API unistat uni_validatefinish(univalidator *validator, unisize *offset) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+{
+    unistat status = UNI_OK;
+
+    if (validator == NULL)
+    {
+        uni_message("required argument 'validator' is null");
+        status = UNI_BAD_OPERATION;
+    }
+    else
+    {
+        status = validator->status;
+    }
+
+    // The stream must not end in the middle of a multi-unit sequence.
+    if ((status == UNI_OK) && (validator->state != 0u))
+    {
+        status = UNI_BAD_ENCODING;
+        validator->status = status;
+    }
+
+    if ((status == UNI_BAD_ENCODING) && (offset != NULL))
+    {
+        *offset = validator->start;
+    }
+
+    return status;
+}
+
+// Advances the offsets of the mark past the character.
+static inline void advance_mark(unimark *mark, unichar cp)
+{
+    if (cp < UNICHAR_C(0x80))
+    {
+        mark->utf8 += 1;
+    }
+    else if (cp < UNICHAR_C(0x800))
+    {
+        mark->utf8 += 2;
+    }
+    else if (cp < UNICHAR_C(0x10000))
+    {
+        mark->utf8 += 3;
+    }
+    else
+    {
+        mark->utf8 += 4;
+    }
+    mark->utf16 += (cp < UNICHAR_C(0x10000)) ? 1 : 2;
+    mark->utf32 += 1;
+}
+
+// Advances the mark past the character that was decoded from the text. The offset for
+// the encoding form of the text is its index which differs from the encoded length
+// of the character when a malformed sequence is replaced.
+static inline void advance_mark_to(unimark *mark, unichar cp, uniattr text_attr, unisize index)
+{
+    advance_mark(mark, cp);
+    switch (GET_ENCODING(text_attr))
+    {
+    case UNI_UTF8:
+        mark->utf8 = index;
+        break;
+    case UNI_UTF16:
+        mark->utf16 = index;
+        break;
+    default:
+        mark->utf32 = index;
+        break;
+    }
+}
+
+// Returns the offset of the mark in the code units of the encoding form.
+static inline unisize mark_offset(const unimark *mark, uniattr attr)
+{
+    unisize offset;
+    switch (GET_ENCODING(attr))
+    {
+    case UNI_UTF8:
+        offset = mark->utf8;
+        break;
+    case UNI_UTF16:
+        offset = mark->utf16;
+        break;
+    default:
+        offset = mark->utf32;
+        break;
+    }
+    return offset;
+}
+
+// Measures the text in all encoding forms by decoding one character at a time.
+// This is the fallback for text that is not trusted to be well-formed.
+static unistat measure_chars(const void *text, unisize text_length, uniattr text_attr, unimark *total)
+{
+    unistat status;
+    unisize i = 0;
+
+    for (;;)
+    {
+        unichar cp;
+        status = uni_nextchar(text, text_length, text_attr, &i, &cp);
+        if (status != UNI_OK)
+        {
+            break;
+        }
+        advance_mark(total, cp);
+    }
+
+    return (status == UNI_DONE) ? UNI_OK : status;
+}
+
+// Measures the text in all encoding forms. The text is scanned in bulk with the
+// counting kernels when it is trusted or proven to be well-formed.
+static unistat measure_text(const void *text, unisize text_length, uniattr text_attr, unimark *total)
+{
+    const bool is_trusted = ((text_attr & UNI_TRUST) == UNI_TRUST) ? true : false;
+    const unisize length = code_units_length(text, text_length, text_attr);
+    unistat status = UNI_BAD_ENCODING;
+
+    switch (GET_ENCODING(text_attr))
+    {
+#if defined(UNICORN_FEATURE_ENCODING_UTF8)
+    case UNI_UTF8:
+        if (is_trusted || (u8_validate(text, length) == UNI_OK))
+        {
+            unisize supplementary = 0;
+            total->utf8 = length;
+            total->utf32 = uni_kernels()->UTF8_count(text, length, &supplementary);
+            total->utf16 = total->utf32 + supplementary;
+            status = UNI_OK;
+        }
+        break;
+#endif
+
+#if defined(UNICORN_FEATURE_ENCODING_UTF16)
+    case UNI_UTF16:
+        {
+            // The UTF-16 kernel detects unpaired surrogates while it counts.
+            unisize bytes_length = 0;
+            const unisize chars = uni_kernels()->UTF16_count(text, length, ((text_attr & UNI_BIG) == UNI_BIG) ? true : false, &bytes_length);
+            if (chars >= 0)
+            {
+                total->utf8 = bytes_length;
+                total->utf16 = length;
+                total->utf32 = chars;
+                status = UNI_OK;
+            }
+        }
+        break;
+#endif
+
+    default:
+        status = measure_chars(text, length, text_attr, total);
+        break;
+    }
+
+    // Malformed text is measured character by character when it is replaced.
+    if ((status == UNI_BAD_ENCODING) && ((text_attr & UNI_REPLACE) == UNI_REPLACE))
+    {
+        total->utf8 = 0;
+        total->utf16 = 0;
+        total->utf32 = 0;
+        status = measure_chars(text, length, text_attr, total);
+    }
+
+    return status;
+}
+
+UNICORN_API unistat uni_count(const void *text, unisize text_len, uniattr text_attr, uniattr count_attr, unisize *count) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+{
+    unistat status = UNI_OK;
+    uniattr attr = count_attr;
+
+    if (count == NULL)
+    {
+        uni_message("required argument 'count' is null");
+        status = UNI_BAD_OPERATION;
+    }
+    else
+    {
+        status = uni_check_input_encoding(text, text_len, &text_attr);
+    }
+
+    if (status == UNI_OK)
+    {
+        status = uni_check_encoding(&attr);
+    }
+
+    if (status == UNI_OK)
+    {
+        unimark total = {0, 0, 0};
+        status = measure_text(text, text_len, text_attr, &total);
+        if (status == UNI_OK)
+        {
+            *count = mark_offset(&total, attr);
+        }
+    }
+
+    return status;
+}
+
+UNICORN_API unistat uni_index(const void *text, unisize text_len, uniattr text_attr, unisize interval, unimark *marks, unisize *marks_len) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+{
+    unistat status = UNI_OK;
+
+    if (marks_len == NULL)
+    {
+        uni_message("required argument 'marks_len' is null");
+        status = UNI_BAD_OPERATION;
+    }
+    else if (*marks_len < 0)
+    {
+        uni_message("marks capacity is negative");
+        status = UNI_BAD_OPERATION;
+    }
+    else if ((marks == NULL) && (*marks_len > 0))
+    {
+        uni_message("marks cannot be null if its capacity is non-zero");
+        status = UNI_BAD_OPERATION;
+    }
+    else if (interval < 1)
+    {
+        uni_message("interval must be positive");
+        status = UNI_BAD_OPERATION;
+    }
+    else
+    {
+        status = uni_check_input_encoding(text, text_len, &text_attr);
+    }
+
+    if (status == UNI_OK)
+    {
+        const unisize capacity = *marks_len;
+        unimark mark = {0, 0, 0};
+        unisize count = 0;
+        unisize i = 0;
+
+        for (;;)
+        {
+            // Record a mark at every interval of characters (including the first).
+            if ((mark.utf32 % interval) == 0)
+            {
+                if (count < capacity)
+                {
+                    marks[count] = mark;
+                }
+                count += 1;
+            }
+
+            unichar cp;
+            status = uni_nextchar(text, text_len, text_attr, &i, &cp);
+            if (status != UNI_OK)
+            {
+                break;
             }
-            break;
+            advance_mark_to(&mark, cp, text_attr, i);
+        }
 
-        // LCOV_EXCL_START: This code path is tested via feature configuration tests.
-        default:
-            UNREACHABLE; // cppcheck-suppress premium-misra-c-2012-17.3
-            status = UNI_MALFUNCTION;
-            break;
-        // LCOV_EXCL_STOP
+        if (status == UNI_DONE)
+        {
+            *marks_len = count;
+            status = (count > capacity) ? UNI_NO_SPACE : UNI_OK;
         }
     }
+
     return status;
 }
 
-UNICORN_API unistat uni_prev(const void *text, unisize text_len, uniattr text_attr, unisize *index, unichar *cp)
+UNICORN_API unistat uni_indexmap(const void *text, unisize text_len, uniattr text_attr, const unimark *marks, unisize marks_len, uniattr from_attr, unisize offset, uniattr to_attr, unisize *result) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
 {
-    ByteSwap16 swap16 = NULL;
-    ByteSwap32 swap32 = NULL;
     unistat status = UNI_OK;
-    
-    // The 'length' parameter is unused in the implementation of decode previous.
-    // It is provided as part of the function signature so it matches the signature of decode next.
-    (void)text_len;
+    uniattr from = from_attr;
+    uniattr to = to_attr;
 
-    if (index == NULL)
+    if ((marks == NULL) || (result == NULL))
     {
-        uni_message("required argument 'index' is null");
+        uni_message("required argument is null");
         status = UNI_BAD_OPERATION;
     }
-    else if (cp == NULL)
+    else if (marks_len < 1)
     {
-        uni_message("required argument 'cp' is null");
+        uni_message("expected at least one mark");
+        status = UNI_BAD_OPERATION;
+    }
+    else if (offset < 0)
+    {
+        uni_message("offset is negative");
         status = UNI_BAD_OPERATION;
     }
     else
@@ -1054,193 +3173,432 @@ UNICORN_API unistat uni_prev(const void *text, unisize text_len, uniattr text_at
 
     if (status == UNI_OK)
     {
-        switch (GET_ENCODING(text_attr)) // LCOV_EXCL_BR_LINE
-        {
-        case UNI_UTF8:
-#if defined(UNICORN_FEATURE_ENCODING_UTF8)
-            if ((text_attr & UNI_TRUST) == UNI_TRUST)
-            {
-                status = u8_prev_unsafe(text, index, cp);
-        }
-            else
-            {
-                status = u8_prev(text, index, cp);
-            }
-#else
-            status = UNI_FEATURE_DISABLED;
-            uni_message("UTF-8 encoding form disabled");
-#endif
-            break;
+        status = uni_check_encoding(&from);
+    }
 
-        case UNI_UTF16:
-#if defined(UNICORN_FEATURE_ENCODING_UTF16)
-            swap16 = ((text_attr & UNI_LITTLE) == UNI_LITTLE) ? &uni_swap16_le : &uni_swap16_be;
-            if ((text_attr & UNI_TRUST) == UNI_TRUST)
-            {
-                status = u16_prev_unsafe(text, index, cp, swap16);
-            }
-            else
-            {
-                status = u16_prev(text, index, cp, swap16);
-            }
-#else
-            status = UNI_FEATURE_DISABLED;
-            uni_message("UTF-16 encoding form disabled");
-#endif
-            break;
+    if (status == UNI_OK)
+    {
+        status = uni_check_encoding(&to);
+    }
 
-        case UNI_UTF32:
-#if defined(UNICORN_FEATURE_ENCODING_UTF32)
-            swap32 = ((text_attr & UNI_LITTLE) == UNI_LITTLE) ? &uni_swap32_le : &uni_swap32_be;
-            if ((text_attr & UNI_TRUST) == UNI_TRUST)
+    if (status == UNI_OK)
+    {
+        // Binary search for the last mark at or before the offset.
+        unisize lo = 0;
+        unisize hi = marks_len - 1;
+        while (lo < hi)
+        {
+            const unisize mid = hi - ((hi - lo) / 2);
+            if (mark_offset(&marks[mid], from) <= offset)
             {
-                status = u32_prev_unsafe(text, index, cp, swap32);
+                lo = mid;
             }
             else
             {
-                status = u32_prev(text, index, cp, swap32);
+                hi = mid - 1;
             }
-#else
-            status = UNI_FEATURE_DISABLED;
-            uni_message("UTF-32 encoding form disabled");
-#endif
-            break;
+        }
 
-        case UNI_SCALAR:
-            if ((text_attr & UNI_TRUST) == UNI_TRUST)
-            {
-                status = scalar_prev_unsafe(text, index, cp);
-            }
-            else
+        // Decode forward from the mark until the offset is reached.
+        unimark mark = marks[lo];
+        unisize i = mark_offset(&mark, text_attr);
+        while (mark_offset(&mark, from) < offset)
+        {
+            unichar cp;
+            status = uni_nextchar(text, text_len, text_attr, &i, &cp);
+            if (status != UNI_OK)
             {
-                status = scalar_prev(text, index, cp);
+                break;
             }
-            break;
+            advance_mark_to(&mark, cp, text_attr, i);
+        }
 
-        // LCOV_EXCL_START: This code path is tested via feature configuration tests.
-        default:
-            UNREACHABLE; // cppcheck-suppress premium-misra-c-2012-17.3
-            status = UNI_MALFUNCTION;
-            break;
-        // LCOV_EXCL_STOP
+        if (status == UNI_DONE)
+        {
+            uni_message("offset is out of bounds");
+            status = UNI_BAD_OPERATION;
+        }
+        else if (status != UNI_OK)
+        {
+            // No Action.
+        }
+        else if (mark_offset(&mark, from) != offset)
+        {
+            uni_message("offset is not on a character boundary");
+            status = UNI_BAD_OPERATION;
+        }
+        else
+        {
+            *result = mark_offset(&mark, to);
         }
     }
+
     return status;
 }
 
-UNICORN_API unistat uni_encode(unichar cp, void *dst, unisize *dst_len, uniattr dst_attr) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+// A contiguous range of the input text processed by one task.
+struct Chunk
 {
-    unistat status = UNI_OK;
-    struct CharBuf buffer = {NULL};
+    unisize start;
+    unisize length;
 
-    if (!is_valid_scalar(cp))
+    // Where the converted chunk is written in the destination and how
+    // many code units it occupies.
+    unisize output_offset;
+    unisize output_length;
+
+    bool is_null_terminated;
+    unistat status;
+};
+
+// State shared by every task processing the chunks of a text.
+struct ChunkedText
+{
+    const void *text;
+    uniattr text_attr;
+    void *output;
+    uniattr output_attr;
+    struct Chunk *chunks;
+};
+
+// Returns the address of the code unit at 'index'.
+static const void *code_unit_at(const void *text, uniattr text_attr, unisize index)
+{
+    const unichar8 *bytes = text; // cppcheck-suppress misra-c2012-11.5
+    return &bytes[(size_t)index * code_unit_size(text_attr)];
+}
+
+// Returns true if a chunk may begin at 'index'. A chunk must never begin in the middle of
+// a character or a maximal subpart of an ill-formed sequence, otherwise processing the chunks
+// independently would disagree with processing the text as a whole.
+static bool is_chunk_boundary(const void *text, uniattr text_attr, unisize index)
+{
+    bool is_boundary;
+    switch (GET_ENCODING(text_attr))
     {
-        status = UNI_BAD_OPERATION;
+    case UNI_UTF8:
+    {
+        const unichar8 *bytes = text; // cppcheck-suppress misra-c2012-11.5
+        is_boundary = ((bytes[index] & (unichar8)0xC0) != (unichar8)0x80) ? true : false;
+        break;
+    }
+    case UNI_UTF16:
+    {
+        const unichar16 *words = text; // cppcheck-suppress misra-c2012-11.5
+        const unichar16 word = ((text_attr & UNI_BIG) == UNI_BIG) ? uni_swap16_be(words[index]) : uni_swap16_le(words[index]);
+        is_boundary = ((word & (unichar16)0xFC00) != (unichar16)0xDC00) ? true : false;
+        break;
+    }
+    default:
+        is_boundary = true;
+        break;
     }
+    return is_boundary;
+}
 
-    if (status == UNI_OK)
+// Divides the text into chunks of roughly 'chunk_length' code units. Each boundary is moved
+// forward past at most three code units: a UTF-8 character or maximal subpart spans no more
+// than three continuation bytes and a UTF-16 character spans no more than one low surrogate.
+static unisize split_text(const void *text, unisize text_length, uniattr text_attr, unisize chunk_length, struct Chunk *chunks)
+{
+    unisize count = 0;
+    unisize start = 0;
+    while (start < text_length)
     {
-        status = uni_charbuf_init(&buffer, dst, dst_len, dst_attr);
-        if (status == UNI_OK)
+        unisize end = ((text_length - start) > chunk_length) ? (start + chunk_length) : text_length;
+        for (int32_t i = 0; i < 3; i++)
         {
-            uni_charbuf_appendchar(&buffer, cp);
-            status = uni_charbuf_finalize(&buffer);
+            if ((end == text_length) || is_chunk_boundary(text, text_attr, end))
+            {
+                break;
+            }
+            end += 1;
+        }
+
+        if (chunks != NULL)
+        {
+            chunks[count].start = start;
+            chunks[count].length = end - start;
+            chunks[count].output_offset = 0;
+            chunks[count].output_length = 0;
+            chunks[count].is_null_terminated = false;
+            chunks[count].status = UNI_OK;
+        }
+        count += 1;
+        start = end;
+    }
+    return count;
+}
+
+// Runs the task for each chunk with the caller supplied runner or, if there is none,
+// sequentially on the calling thread.
+static void run_tasks(unirunfunc run, void *user_data, unitaskfunc task, struct ChunkedText *chunked, unisize count)
+{
+    if (run != NULL)
+    {
+        run(user_data, task, chunked, count);
+    }
+    else
+    {
+        for (unisize i = 0; i < count; i++)
+        {
+            task(chunked, i);
         }
     }
+}
 
+// Allocates and populates the chunks for the text.
+static unistat allocate_chunks(const void *text, unisize text_length, uniattr text_attr, unisize chunk_length, struct Chunk **chunks, unisize *count)
+{
+    unistat status = UNI_OK;
+    *count = split_text(text, text_length, text_attr, chunk_length, NULL);
+    *chunks = NULL;
+    if (*count > 0)
+    {
+        *chunks = uni_malloc(sizeof(struct Chunk) * (size_t)*count); // cppcheck-suppress misra-c2012-11.5
+        if (*chunks == NULL)
+        {
+            uni_message("memory allocation failed");
+            status = UNI_NO_MEMORY;
+        }
+        else
+        {
+            (void)split_text(text, text_length, text_attr, chunk_length, *chunks);
+        }
+    }
     return status;
 }
 
-UNICORN_API unistat uni_convert(const void *src, unisize src_len, uniattr src_attr, void *dst, unisize *dst_len, uniattr dst_attr) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+static void validate_chunk_task(void *task_data, unisize index)
+{
+    const struct ChunkedText *chunked = task_data; // cppcheck-suppress misra-c2012-11.5
+    struct Chunk *chunk = &chunked->chunks[index];
+    const void *text = code_unit_at(chunked->text, chunked->text_attr, chunk->start);
+    chunk->status = validate_text(text, chunk->length, chunked->text_attr);
+}
+
+UNICORN_API unistat uni_validatepar(const void *text, unisize text_len, uniattr text_attr, unisize chunk_len, unirunfunc run, void *user_data) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
 {
     unistat status = UNI_OK;
 
-    if (src == NULL)
+    if (text == NULL)
     {
         uni_message("required argument is null");
         status = UNI_BAD_OPERATION;
     }
+    else if (chunk_len <= 0)
+    {
+        uni_message("chunk length must be positive");
+        status = UNI_BAD_OPERATION;
+    }
+    else
+    {
+        status = uni_check_input_encoding(text, text_len, &text_attr);
+    }
 
     if (status == UNI_OK)
     {
-        status = uni_check_input_encoding(src, src_len, &src_attr);
+        if ((text_attr & UNI_TRUST) == UNI_TRUST)
+        {
+            uni_message("trust flag is self-defeating");
+            status = UNI_BAD_OPERATION;
+        }
+        else if ((text_attr & UNI_REPLACE) == UNI_REPLACE)
+        {
+            uni_message("replace flag is self-defeating");
+            status = UNI_BAD_OPERATION;
+        }
+        else
+        {
+            // No Action.
+        }
     }
 
-    if (status == UNI_OK)
+    if ((status == UNI_OK) && uni_heap_disabled())
     {
-        struct CharBuf buffer = {NULL};
-        status = uni_charbuf_init(&buffer, dst, dst_len, dst_attr);
+        // The chunks are heap allocated therefore the text is validated sequentially.
+        status = validate_text(text, code_units_length(text, text_len, text_attr), text_attr);
+    }
+    else if (status == UNI_OK)
+    {
+        const unisize length = code_units_length(text, text_len, text_attr);
+        struct Chunk *chunks;
+        unisize count;
+        status = allocate_chunks(text, length, text_attr, chunk_len, &chunks, &count);
         if (status == UNI_OK)
         {
-            unisize i = 0;
-            for (;;)
+            struct ChunkedText chunked = {
+                .text = text,
+                .text_attr = text_attr,
+                .chunks = chunks,
+            };
+
+            // Select the kernels before the tasks run so they are never selected concurrently.
+            (void)uni_kernels();
+            run_tasks(run, user_data, &validate_chunk_task, &chunked, count);
+
+            for (unisize i = 0; i < count; i++)
             {
-                unichar cp;
-                status = uni_next(src, src_len, src_attr, &i, &cp);
-                if (status == UNI_OK)
-                {
-                    uni_charbuf_appendchar(&buffer, cp);
-                }
-                else
+                if (chunks[i].status != UNI_OK)
                 {
+                    status = chunks[i].status;
                     break;
                 }
             }
-
-            if (status == UNI_DONE)
-            {
-                status = uni_charbuf_finalize(&buffer);
-            }
+            uni_free(chunks, sizeof(struct Chunk) * (size_t)count);
         }
     }
 
     return status;
 }
 
-UNICORN_API unistat uni_validate(const void *text, unisize text_len, uniattr text_attr) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+// Converts the chunk into a buffer that is either null, to measure the length of the
+// converted chunk, or the exact region of the destination reserved for the chunk.
+static void convert_chunk(const struct ChunkedText *chunked, struct Chunk *chunk, void *output)
+{
+    struct CharBuf buffer = {NULL};
+    const void *text = code_unit_at(chunked->text, chunked->text_attr, chunk->start);
+    chunk->status = uni_charbuf_init(&buffer, output, &chunk->output_length, chunked->output_attr);
+    if (chunk->status == UNI_OK)
+    {
+        chunk->status = convert_text(text, chunk->length, chunked->text_attr, &buffer);
+        if (chunk->status == UNI_DONE)
+        {
+            chunk->status = uni_charbuf_finalize(&buffer);
+            chunk->is_null_terminated = buffer.is_null_terminated;
+        }
+    }
+}
+
+static void measure_chunk_task(void *task_data, unisize index)
+{
+    const struct ChunkedText *chunked = task_data; // cppcheck-suppress misra-c2012-11.5
+    convert_chunk(chunked, &chunked->chunks[index], NULL);
+}
+
+static void convert_chunk_task(void *task_data, unisize index)
+{
+    const struct ChunkedText *chunked = task_data; // cppcheck-suppress misra-c2012-11.5
+    struct Chunk *chunk = &chunked->chunks[index];
+    unichar8 *output = chunked->output; // cppcheck-suppress misra-c2012-11.5
+    convert_chunk(chunked, chunk, &output[(size_t)chunk->output_offset * code_unit_size(chunked->output_attr)]);
+}
+
+UNICORN_API unistat uni_convertpar(const void *src, unisize src_len, uniattr src_attr, void *dst, unisize *dst_len, uniattr dst_attr, unisize chunk_len, unirunfunc run, void *user_data) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
 {
     unistat status = UNI_OK;
+    struct CharBuf buffer = {NULL};
 
-    if (text == NULL)
+    if (src == NULL)
     {
         uni_message("required argument is null");
         status = UNI_BAD_OPERATION;
     }
+    else if (chunk_len <= 0)
+    {
+        uni_message("chunk length must be positive");
+        status = UNI_BAD_OPERATION;
+    }
+    else
+    {
+        status = uni_check_input_encoding(src, src_len, &src_attr);
+    }
 
     if (status == UNI_OK)
     {
-        status = uni_check_input_encoding(text, text_len, &text_attr);
+        status = uni_charbuf_init(&buffer, dst, dst_len, dst_attr);
     }
 
-    if (status == UNI_OK)
+    if ((status == UNI_OK) && ((buffer.sink != NULL) || (buffer.cursor != NULL) || uni_heap_disabled()))
     {
-        // The 'trust' flag is useless for this function because its entire
-        // purpose is to verify that the input text is well-formed therefore
-        // assuming it is well formed via the 'trust' flag defeats this purpose.
-        if ((text_attr & UNI_TRUST) == UNI_TRUST)
+        // Output delivered to a sink must arrive in order, and resumable output must stop
+        // where the buffer is full, therefore they're converted sequentially. The chunks are
+        // heap allocated so text is also converted sequentially when the heap is disabled.
+        status = convert_text(src, src_len, src_attr, &buffer);
+        if (status == UNI_DONE)
         {
-            uni_message("trust flag is self-defeating");
-            status = UNI_BAD_OPERATION;
+            status = uni_charbuf_finalize(&buffer);
         }
     }
-
-    if (status == UNI_OK)
+    else if (status == UNI_OK)
     {
-        unisize i = 0;
-        for (;;)
+        const unisize length = code_units_length(src, src_len, src_attr);
+        struct Chunk *chunks;
+        unisize count;
+        status = allocate_chunks(src, length, src_attr, chunk_len, &chunks, &count);
+        if (status == UNI_OK)
         {
-            unichar cp;
-            status = uni_next(text, text_len, text_attr, &i, &cp);
-            if (status != UNI_OK)
+            // The chunks are converted without the null terminator; it's appended
+            // to the destination as a whole once every chunk has been written.
+            struct ChunkedText chunked = {
+                .text = src,
+                .text_attr = src_attr,
+                .output = buffer.storage,
+                .output_attr = buffer.encoding & ~(UNI_NULIFY | UNI_ALLOC | UNI_SHRINK),
+                .chunks = chunks,
+            };
+
+            // Measure the converted length of every chunk.
+            (void)uni_kernels();
+            run_tasks(run, user_data, &measure_chunk_task, &chunked, count);
+
+            // Compute the offset of each chunk in the destination from the prefix sum of
+            // the converted lengths. The text is converted sequentially if it doesn't fit
+            // so partial output is identical to uni_convert().
+            for (unisize i = 0; i < count; i++)
             {
-                break;
+                if (chunks[i].status != UNI_OK)
+                {
+                    status = chunks[i].status;
+                    break;
+                }
+                chunks[i].output_offset = buffer.length;
+                buffer.length += chunks[i].output_length;
+                buffer.is_null_terminated = chunks[i].is_null_terminated;
             }
-        }
 
-        if (status == UNI_DONE)
-        {
-            status = UNI_OK;
+            if ((status == UNI_OK) && (buffer.alloc != NULL))
+            {
+                // The converted length is known therefore the allocation grows once to hold it.
+                const unisize length = buffer.length;
+                buffer.length = 0;
+                uni_charbuf_reserve(&buffer, (buffer.null_terminate && !buffer.is_null_terminated) ? (length + 1) : length);
+                buffer.length = length;
+                chunked.output = buffer.storage;
+                status = buffer.status;
+            }
+
+            if ((status == UNI_OK) && (buffer.storage != NULL))
+            {
+                const unisize required = (buffer.null_terminate && !buffer.is_null_terminated) ? (buffer.length + 1) : buffer.length;
+                if (required <= buffer.capacity)
+                {
+                    run_tasks(run, user_data, &convert_chunk_task, &chunked, count);
+                    for (unisize i = 0; i < count; i++)
+                    {
+                        if (chunks[i].status != UNI_OK)
+                        {
+                            status = chunks[i].status; // LCOV_EXCL_LINE
+                            break; // LCOV_EXCL_LINE
+                        }
+                    }
+                    buffer.written = buffer.length;
+                }
+                else
+                {
+                    buffer.length = 0;
+                    buffer.is_null_terminated = false;
+                    status = convert_text(src, src_len, src_attr, &buffer);
+                }
+            }
+
+            if ((status == UNI_OK) || (status == UNI_DONE))
+            {
+                status = uni_charbuf_finalize(&buffer);
+            }
+            uni_free(chunks, sizeof(struct Chunk) * (size_t)count);
         }
     }
+
     return status;
 }
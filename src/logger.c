@@ -24,8 +24,18 @@ UNICORN_API void uni_seterrfunc(void *user_data, unierrfunc callback) // cppchec
 
 void uni_message(const char *msg)
 {
-    if (unicorn_logger_cb != NULL)
+    // The logger of the context installed by the calling thread takes precedence.
+    const unicontext *context = uni_getcontext();
+    if ((context != NULL) && (context->errf != NULL))
+    {
+        context->errf(context->err_data, msg);
+    }
+    else if (unicorn_logger_cb != NULL)
     {
         unicorn_logger_cb(unicorn_logger_ud, msg);
     }
+    else
+    {
+        // No Action.
+    }
 }
@@ -59,7 +59,26 @@ UNICORN_API unistat uni_setmemfunc(void *user_data, unimemfunc allocf) // cppche
     return status;
 }
 
-void *uni_malloc(size_t size)
+// Returns the allocator of the context installed by the calling thread, if it has one,
+// otherwise the process-wide allocator is returned.
+static unimemfunc get_allocator(void **user_data)
+{
+    const unicontext *context = uni_getcontext();
+    unimemfunc allocf;
+    if ((context != NULL) && (context->allocf != NULL))
+    {
+        allocf = context->allocf;
+        *user_data = context->alloc_data;
+    }
+    else
+    {
+        allocf = unicorn_allocf;
+        *user_data = unicorn_ud;
+    }
+    return allocf;
+}
+
+void *uni_global_malloc(size_t size)
 {
     void *ptr = NULL;
     if (unicorn_allocf != NULL) // LCOV_EXCL_BR_LINE: Branch taken only by the features.json combinations tests.
@@ -69,7 +88,7 @@ void *uni_malloc(size_t size)
     return ptr;
 }
 
-void *uni_realloc(void *old_ptr, size_t old_size, size_t new_size)
+void *uni_global_realloc(void *old_ptr, size_t old_size, size_t new_size)
 {
     void *new_ptr = NULL;
     if (unicorn_allocf != NULL) // LCOV_EXCL_BR_LINE: Branch taken only by the features.json combinations tests.
@@ -79,10 +98,57 @@ void *uni_realloc(void *old_ptr, size_t old_size, size_t new_size)
     return new_ptr;
 }
 
-void uni_free(void *ptr, size_t size)
+void uni_global_free(void *ptr, size_t size)
 {
     if (unicorn_allocf != NULL) // LCOV_EXCL_BR_LINE: Branch taken only by the features.json combinations tests.
     {
         (void)unicorn_allocf(unicorn_ud, ptr, size, 0);
     }
 }
+
+void *uni_malloc(size_t size)
+{
+    void *ptr = NULL;
+    void *ud;
+    const unimemfunc allocf = get_allocator(&ud);
+    if ((allocf != NULL) && !uni_heap_disabled()) // LCOV_EXCL_BR_LINE: Branch taken only by the features.json combinations tests.
+    {
+        ptr = allocf(ud, NULL, 0, size);
+    }
+    return ptr;
+}
+
+void *uni_realloc(void *old_ptr, size_t old_size, size_t new_size)
+{
+    void *new_ptr = NULL;
+    void *ud;
+    const unimemfunc allocf = get_allocator(&ud);
+    if ((allocf != NULL) && !uni_heap_disabled()) // LCOV_EXCL_BR_LINE: Branch taken only by the features.json combinations tests.
+    {
+        new_ptr = allocf(ud, old_ptr, old_size, new_size);
+    }
+    return new_ptr;
+}
+
+void uni_free(void *ptr, size_t size)
+{
+    void *ud;
+    const unimemfunc allocf = get_allocator(&ud);
+    if (allocf != NULL) // LCOV_EXCL_BR_LINE: Branch taken only by the features.json combinations tests.
+    {
+        (void)allocf(ud, ptr, size, 0);
+    }
+}
+
+UNICORN_API void uni_freebuf(unibuf *buf) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+{
+    if (buf != NULL)
+    {
+        if (buf->data != NULL)
+        {
+            uni_free(buf->data, buf->size);
+        }
+        buf->data = NULL;
+        buf->size = 0;
+    }
+}
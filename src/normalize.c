@@ -27,6 +27,22 @@ static const int32_t hangul_S_count = 11172;
 
 typedef uint32_t(*QuickCheckFunc)(unichar cp);
 
+#if defined(UNICORN_FEATURE_NFC_QUICK_CHECK)
+static inline uint32_t quick_check_NFC(unichar character)
+{
+    const uint32_t flags = (uint32_t)unicorn_get_codepoint_data(character)->quick_check_flags;
+    return flags >> 4u;
+}
+#endif
+
+#if defined(UNICORN_FEATURE_NFD_QUICK_CHECK)
+static inline uint32_t quick_check_NFD(unichar character)
+{
+    const uint32_t flags = (uint32_t)unicorn_get_codepoint_data(character)->quick_check_flags;
+    return flags & 0xFu;
+}
+#endif
+
 // The conditional logic in the following function is for algorithmically
 // decomposing characters in the Korean alphabet, also known as Hangul.
 // The algorithm is described in the Unicode Standard. Refer to it for details.
@@ -40,7 +56,7 @@ static unisize get_canonical_decomposition(unichar character, unichar *decomposi
     {
         // Non-Hangul character: look up its decomposition in the decomposition mappings table.
 #if defined(UNICORN_OPTIMIZE_FOR_SPEED)
-        // When optimizing for speed, the decomposition is stored as UTF-32.
+        // When optimizing for speed, the full decomposition is stored as UTF-32.
         // Each character can be copied as-is to the destination buffer.
         const unichar *chars = &uni_canonical_decomp_mappings[unicorn_get_codepoint_data(character)->canonical_decomposition_mapping_offset];
         const unichar chars_len = chars[0];
@@ -63,7 +79,7 @@ static unisize get_canonical_decomposition(unichar character, unichar *decomposi
         while (index < (unisize)utf8_len)
         {
             unichar cp;
-            const unistat status = uni_next(utf8, utf8_len, UNI_UTF8 | UNI_TRUST, &index, &cp);
+            const unistat status = uni_nextchar(utf8, utf8_len, UNI_UTF8 | UNI_TRUST, &index, &cp);
             assert(status == UNI_OK); // LCOV_EXCL_BR_LINE
             if (decomposition != NULL)
             {
@@ -104,12 +120,23 @@ static unisize get_canonical_decomposition(unichar character, unichar *decomposi
     return unichar_count;
 }
 
-void uni_norm_init(struct NormalizeState *state, IsStable is_stable)
+void uni_norm_init(struct NormalizeState *state, IsStable is_stable, uniworkspace *workspace)
 {
     (void)memset(state, 0, sizeof(state[0]));
     state->is_stable = is_stable;
-    uni_charvec_init(&state->span);
-    uni_charvec_init(&state->decomp);
+    uni_charvec_init(&state->span, workspace);
+    uni_charvec_init(&state->decomp, workspace);
+    if (uni_heap_disabled())
+    {
+        // The decomposed characters and a terminator must fit the decomposition buffer and the
+        // scanned characters must fit the span buffer. Their capacity is the stack buffer unless
+        // they borrowed larger storage from a workspace.
+        state->limit = uni_charvec_capacity(&state->decomp) - UNISIZE_C(1);
+        if (state->limit > uni_charvec_capacity(&state->span))
+        {
+            state->limit = uni_charvec_capacity(&state->span);
+        }
+    }
 }
 
 void uni_norm_free(struct NormalizeState *state)
@@ -235,38 +262,27 @@ static void sort_combining_marks(unichar codepoints[], int32_t length)
 
 #if defined(UNICORN_FEATURE_NFC)
 
-static unichar find_canonical_composition(const struct CanonicalCompositionPair *const pairs, int32_t left, int32_t right, const unichar codepoint)
+static unihash hash_pair(unichar starter, unichar combining)
 {
-    unichar composition = UNICORN_LARGEST_CODE_POINT;
-    if (right >= left)
-    {
-        const int32_t middle = left + ((right - left) / 2);
-        const struct CanonicalCompositionPair *const pair = &pairs[middle];
-        // Check the left or right subarray.
-        if (pair->codepoint > codepoint)
-        {
-            composition = find_canonical_composition(pairs, left, middle - 1, codepoint); // cppcheck-suppress misra-c2012-17.2
-        }
-        else if (pair->codepoint < codepoint)
-        {
-            composition = find_canonical_composition(pairs, middle + 1, right, codepoint); // cppcheck-suppress misra-c2012-17.2
-        }
-        else
-        {
-            composition = pair->composed_codepoint;
-        }
-    }
-    return composition;
+    return uni_hash_char((unichar)uni_hash_char(starter) ^ combining);
 }
 
-static unichar find_composition(unichar starter, unichar non_starter)
+// Returns the composition of the characters or UNICORN_LARGEST_CODE_POINT if they don't compose.
+// The compositions are stored in a perfect hash table keyed on the pair of characters.
+static unichar find_composition(unichar starter, unichar combining)
 {
-    // Find the sorted array with all characters the starter character can compose with.
-    const struct CodepointData *character = unicorn_get_codepoint_data(starter);
-    const struct CanonicalCompositionPair *const pairs = &uni_canonical_comp_pairs[character->canonical_composition_mapping_offset];
-    const int32_t composition_mapping_count = (int32_t)character->canonical_composition_mapping_count;
-    assert(composition_mapping_count > 0); // LCOV_EXCL_BR_LINE: This condition is checked for by the caller.
-    return find_canonical_composition(pairs, 0, composition_mapping_count, non_starter); // cppcheck-suppress misra-c2012-17.2
+    const unihash hash = hash_pair(starter, combining);
+    const uint32_t length = CANONICAL_COMPOSITIONS_COUNT;
+    const uint32_t seed_index = hash % length;
+    const uint32_t value_index = uni_xorshift(hash + (unihash)uni_canonical_comp_seeds[seed_index]) % length;
+    const struct CanonicalComposition *composition = &uni_canonical_comps[value_index];
+
+    unichar composed = UNICORN_LARGEST_CODE_POINT;
+    if ((composition->starter == starter) && (composition->combining == combining))
+    {
+        composed = composition->composed;
+    }
+    return composed;
 }
 
 static void compose_combining_character_sequence(struct CharVec *buffer, unisize index)
@@ -284,7 +300,7 @@ static void compose_combining_character_sequence(struct CharVec *buffer, unisize
         unichar starter = buffer->chars[index];
 
         // Check if this code point can be composed with another.
-        const bool is_composable = unicorn_get_codepoint_data(starter)->canonical_composition_mapping_count > (uint8_t)0;
+        const bool is_composable = (((uint32_t)unicorn_get_codepoint_data(starter)->flags & CHAR_IS_COMPOSABLE) == CHAR_IS_COMPOSABLE);
 
         // This character should be a starter.
         if ((get_ccc(starter) != 0) || !is_composable)
@@ -319,6 +335,14 @@ static void compose_combining_character_sequence(struct CharVec *buffer, unisize
                     restart = true;
                 }
             }
+            else if (ccc == 0)
+            {
+                break; // A starter that didn't compose blocks the characters after it.
+            }
+            else
+            {
+                // No Action.
+            }
         }
     } while (restart);
 }
@@ -399,12 +423,20 @@ static void norm_compose(struct CharVec *buffer)
 }
 #endif
 
-static unisize decompose(unichar ch, unichar chars[LONGEST_UNICHAR_DECOMPOSITION])
+unisize uni_norm_decompose(unichar ch, unichar chars[LONGEST_UNICHAR_DECOMPOSITION])
 {
+#if defined(UNICORN_OPTIMIZE_FOR_SPEED)
+    // The decompositions are fully expanded when optimizing for speed so one lookup suffices.
+    unisize length = get_canonical_decomposition(ch, chars);
+    if (length == 0)
+    {
+        chars[0] = ch;
+        length = 1;
+    }
+#else
     int32_t index = 0;
     int32_t length = 1;
 
-    (void)memset(chars, 0, sizeof(unichar) * (size_t)LONGEST_UNICHAR_DECOMPOSITION);
     chars[0] = ch;
 
     while (index < length)
@@ -430,17 +462,166 @@ static unisize decompose(unichar ch, unichar chars[LONGEST_UNICHAR_DECOMPOSITION
         (void)memcpy(&chars[index], decomp, sizeof(chars[0]) * (size_t)decomp_length);
         length += (decomp_length - 1);
     }
+#endif
+
+    return length;
+}
 
+// Writes the full canonical decomposition of the character, and the Canonical Combining Class of
+// each character of the decomposition, and returns the length of the decomposition.
+static unisize decompose_with_ccc(unichar ch, unichar chars[LONGEST_UNICHAR_DECOMPOSITION], int32_t cccs[LONGEST_UNICHAR_DECOMPOSITION])
+{
+#if defined(UNICORN_OPTIMIZE_FOR_SPEED)
+    // The decomposition and the combining classes of its characters are stored side by side so
+    // both are read with the same lookup. Hangul syllables aren't in the table and are decomposed
+    // algorithmically into Hangul Jamo which are starters.
+    const struct CodepointData *data = unicorn_get_codepoint_data(ch);
+    const size_t offset = (size_t)data->canonical_decomposition_mapping_offset;
+    unisize length = (unisize)uni_canonical_decomp_mappings[offset];
+    if (length > 0)
+    {
+        assert(length <= LONGEST_UNICHAR_DECOMPOSITION); // LCOV_EXCL_BR_LINE
+        (void)memcpy(chars, &uni_canonical_decomp_mappings[offset + 1u], sizeof(chars[0]) * (size_t)length);
+        for (unisize i = 0; i < length; i++)
+        {
+            cccs[i] = (int32_t)uni_canonical_decomp_cccs[offset + 1u + (size_t)i];
+        }
+    }
+    else if (((int32_t)ch >= hangul_S_base) && ((int32_t)ch < (hangul_S_base + hangul_S_count)))
+    {
+        length = get_canonical_decomposition(ch, chars);
+        for (unisize i = 0; i < length; i++)
+        {
+            cccs[i] = 0;
+        }
+    }
+    else
+    {
+        chars[0] = ch;
+        cccs[0] = (int32_t)data->canonical_combining_class;
+        length = 1;
+    }
+#else
+    const unisize length = uni_norm_decompose(ch, chars);
+    for (unisize i = 0; i < length; i++)
+    {
+        cccs[i] = get_ccc(chars[i]);
+    }
+#endif
     return length;
 }
 
+// Returns 'true' if a run can end before the character without changing how the text normalizes.
+// That's the case when the character decomposes to a starter that can't compose with the characters
+// before it: combining marks are never reordered across a starter and they can't compose past it.
+static bool is_run_boundary(unichar ch)
+{
+    unichar decomp[LONGEST_UNICHAR_DECOMPOSITION];
+    (void)uni_norm_decompose(ch, decomp);
+    bool is_boundary = (get_ccc(decomp[0]) == 0);
+
+#if defined(UNICORN_FEATURE_NFC)
+    if (is_hangul_syllable_V(decomp[0]) || is_hangul_syllable_T(decomp[0]))
+    {
+        is_boundary = false;
+    }
+    else if (is_boundary)
+    {
+        // Some starters are the second character of a composition.
+        for (size_t i = 0; i < COUNT_OF(uni_canonical_comps); i++)
+        {
+            if (uni_canonical_comps[i].combining == decomp[0])
+            {
+                is_boundary = false;
+                break;
+            }
+        }
+    }
+    else
+    {
+        // No Action.
+    }
+#endif
+
+    return is_boundary;
+}
+
+// Shortens a run that exceeds the limit of the normalization state so it ends at the last
+// character it can end before. The characters of the run were recorded in the span buffer.
+// The decomposition and the text index are rewound to the end of the shortened run.
+static unistat end_bounded_run(struct NormalizeState *state, const struct unitext *it, unisize *span_length, unisize *index)
+{
+    unistat status = UNI_TOO_LONG;
+    for (unisize i = *span_length - UNISIZE_C(1); i > 0; i--)
+    {
+        if (is_run_boundary(state->span.chars[i]))
+        {
+            *span_length = i;
+            status = UNI_OK;
+            break;
+        }
+    }
+
+    if (status == UNI_OK)
+    {
+        // This only happens for unusually long runs, so the characters are decoded and
+        // decomposed again rather than tracking where each of them ended.
+        unichar decomp[LONGEST_UNICHAR_DECOMPOSITION];
+        state->decomp.length = 0;
+        *index = it->index;
+        for (unisize i = 0; i < *span_length; i++)
+        {
+            unichar cp;
+            const unistat decode_status = uni_nextchar(it->data, it->length, it->encoding, index, &cp);
+            assert(decode_status == UNI_OK); // LCOV_EXCL_BR_LINE
+            (void)decode_status;
+            state->decomp.length += uni_norm_decompose(cp, decomp);
+        }
+    }
+    else
+    {
+        uni_message("character sequence exceeds the stack buffer and heap allocation is disabled");
+    }
+    return status;
+}
+
+// Sorts each sequence of combining marks in the decomposition by their canonical combining class.
+static void reorder_combining_marks(struct CharVec *decomp)
+{
+    unisize index = 0;
+    while (index < decomp->length)
+    {
+        // Skip starters.
+        if (get_ccc(decomp->chars[index]) == 0)
+        {
+            index += 1;
+            continue;
+        }
+
+        // Find the last combining mark in this range of combining marks.
+        unisize end = index + 1;
+        while (end != decomp->length)
+        {
+            if (get_ccc(decomp->chars[end]) == 0)
+            {
+                break;
+            }
+            end += 1;
+        }
+
+        sort_combining_marks(&decomp->chars[index], end - index);
+        index = end;
+    }
+}
+
 unistat uni_norm_append_run(struct NormalizeState *state, struct unitext *it)
 {
     unistat status = UNI_OK;
     unisize span_length = 0;
-    unichar cp;
-    struct unitext copy = *it;
-    unichar decomp[LONGEST_UNICHAR_DECOMPOSITION];
+    unisize index = it->index;
+    bool done = false;
+    bool is_ordered = true;
+    int32_t last_ccc = 0;
 
     // More decomposed characters shouldn't be requested unless the buffer is empty.
     assert(uni_norm_is_empty(state)); // LCOV_EXCL_BR_LINE
@@ -448,11 +629,19 @@ unistat uni_norm_append_run(struct NormalizeState *state, struct unitext *it)
     // Reset the buffer.
     uni_norm_reset(state);
 
-    // Determine the span of characters until the next stable character.
-    bool done = false;
+    // Decode and decompose characters until the next stable character. Each character is decoded
+    // and decomposed once, directly into the decomposition buffer.
     do
     {
-        status = uni_next(copy.data, copy.length, copy.encoding, &copy.index, &cp);
+        unichar cp;
+        status = uni_nextchar(it->data, it->length, it->encoding, &index, &cp);
+        if ((status == UNI_OK) && (state->limit == 0))
+        {
+            // Make room for the longest decomposition and a terminator. When the heap is disabled
+            // the buffer has room for the limit and a terminator so it's never grown.
+            status = uni_charvec_grow(&state->decomp, state->decomp.length + LONGEST_UNICHAR_DECOMPOSITION + UNISIZE_C(1));
+        }
+
         if (status != UNI_OK)
         {
             // If this is the first iteration of the loop and the iteration
@@ -465,98 +654,235 @@ unistat uni_norm_append_run(struct NormalizeState *state, struct unitext *it)
         }
         else
         {
-            span_length += 1;
-            if (state->is_stable(cp))
+            unichar decomp[LONGEST_UNICHAR_DECOMPOSITION];
+            int32_t cccs[LONGEST_UNICHAR_DECOMPOSITION];
+            const unisize len = decompose_with_ccc(cp, decomp, cccs);
+            if ((state->limit > 0) && ((state->decomp.length + len) > state->limit))
             {
-                done = true; // This character is stable.
+                // The run is cut short because its decomposition wouldn't fit the stack buffer.
+                status = end_bounded_run(state, it, &span_length, &index);
+                done = true;
+            }
+            else
+            {
+                if (state->limit > 0)
+                {
+                    // Record the character in case the run must be cut short.
+                    state->span.chars[span_length] = cp;
+                }
+                uni_charvec_append_unsafe(&state->decomp, decomp, len);
+                span_length += 1;
+
+                // Combining marks only need reordering if a mark follows one with a higher class.
+                for (unisize i = 0; i < len; i++)
+                {
+                    if ((cccs[i] != 0) && (cccs[i] < last_ccc))
+                    {
+                        is_ordered = false;
+                    }
+                    last_ccc = cccs[i];
+                }
+                done = state->is_stable(cp);
             }
         }
     } while (!done);
 
     if (status == UNI_OK)
     {
-        // Make sure the buffer is large enough to accommodate.
-        status = uni_charvec_reserve(&state->span, span_length);
+        it->index = index;
+        if (!is_ordered)
+        {
+            reorder_combining_marks(&state->decomp);
+        }
+        state->r = state->decomp.length;
+    }
+    else
+    {
+        uni_charvec_reset(&state->decomp);
     }
 
-    unisize decomp_length = 0;
-    if (status == UNI_OK)
+    return status;
+}
+
+static inline unichar uni_norm_pop(struct NormalizeState *state)
+{
+    assert(!uni_norm_is_empty(state)); // LCOV_EXCL_BR_LINE
+    const unichar ch = state->decomp.chars[state->offset];
+    state->offset += 1;
+    return ch;
+}
+
+// Destination of the normalized text. If 'changed' is non-null, then writing to the destination is
+// deferred until normalization changes the text. Until then the destination isn't touched, not even
+// initialized, so nothing is written, or allocated, for text that's already normalized. When the
+// text changes the deferred text preceding the change is copied from the source.
+struct NormOutput
+{
+    struct CharBuf buffer;
+    void *dst;
+    unisize *dst_len;
+    uniattr dst_attr;
+    bool *changed;
+};
+
+static unistat output_init(struct NormOutput *out, void *dst, unisize *dst_len, uniattr dst_attr, bool *changed)
+{
+    unistat status;
+
+    out->dst = dst;
+    out->dst_len = dst_len;
+    out->dst_attr = dst_attr;
+    out->changed = changed;
+
+    if (changed == NULL)
+    {
+        status = uni_charbuf_init(&out->buffer, dst, dst_len, dst_attr);
+    }
+    else
     {
-        // Copy over the span of characters.
-        for (int32_t i = 0; i < span_length; i++)
+        // The buffer is zeroed so it behaves as a buffer that isn't resumable until it's initialized.
+        (void)memset(&out->buffer, 0, sizeof(out->buffer));
+        *changed = false;
+        status = uni_check_output_encoding(dst, dst_len, &dst_attr);
+        if ((status == UNI_OK) && ((dst_attr & UNI_CURSOR) == UNI_CURSOR))
         {
-            // No need to check the return type here since the entire span of character
-            // has already been scanned one (and no illegal characters were found).
-            status = uni_next(it->data, it->length, it->encoding, &it->index, &state->span.chars[i]);
-            assert(status == UNI_OK); // LCOV_EXCL_BR_LINE
+            uni_message("'UNI_CURSOR' flag is incompatible with deferred output");
+            status = UNI_BAD_OPERATION;
         }
+    }
 
-        // Calculate the length of the fully decomposed span.
-        for (int32_t i = 0; i < span_length; i++)
+    return status;
+}
+
+static bool output_is_deferred(const struct NormOutput *out)
+{
+    return (out->changed != NULL) && !*out->changed;
+}
+
+// Returns true if the characters between the code unit offsets 'start' and 'end' of the text are
+// identical to the characters. Malformed characters are never identical because the normalization
+// pipeline replaces them, if it doesn't reject them.
+static bool is_same_text(const struct unitext *it, unisize start, unisize end, const unichar *chars, unisize chars_count)
+{
+    const uniattr encoding = it->encoding & ~UNI_REPLACE;
+    bool is_same = true;
+    unisize index = start;
+    unisize count = 0;
+
+    while (is_same && (index < end))
+    {
+        unichar cp;
+        const unistat status = uni_nextchar(it->data, it->length, encoding, &index, &cp);
+        if ((status != UNI_OK) || (count == chars_count) || (chars[count] != cp))
         {
-            decomp_length += decompose(state->span.chars[i], decomp);
+            is_same = false;
         }
-
-        // Resize the buffer to make room for the decomposition.
-        const unisize new_capacity = state->decomp.length + decomp_length + UNISIZE_C(1);
-        status = uni_charvec_reserve(&state->decomp, new_capacity);
+        count += 1;
     }
 
-    if (status == UNI_OK)
+    return is_same && (count == chars_count);
+}
+
+// Appends the normalization of the characters between 'start' and the iterator. If the output is
+// deferred and the characters are unchanged by normalization, then nothing is appended.
+static unistat output_append(struct NormOutput *out, const struct unitext *it, unisize start, const unichar *chars, unisize chars_count)
+{
+    unistat status = UNI_OK;
+
+    if (!output_is_deferred(out))
+    {
+        uni_charbuf_append(&out->buffer, chars, chars_count);
+    }
+    else if (!is_same_text(it, start, it->index, chars, chars_count))
     {
-        // Append the decomposed characters.
-        unichar *full_decomp = &state->decomp.chars[state->decomp.length];
-        for (int32_t i = 0; i < span_length; i++)
+        *out->changed = true;
+        status = uni_charbuf_init(&out->buffer, out->dst, out->dst_len, out->dst_attr);
+        if (status == UNI_OK)
         {
-            const unisize len = decompose(state->span.chars[i], decomp);
-            uni_charvec_append_unsafe(&state->decomp, decomp, len);
+            uni_charbuf_append_text(&out->buffer, it->data, 0, start, it->encoding);
+            uni_charbuf_append(&out->buffer, chars, chars_count);
         }
+    }
+    else
+    {
+        // No Action.
+    }
 
-        // Sort sequences of combining marks.
-        unisize index = 0;
-        while (index < decomp_length)
-        {
-            // Skip starters.
-            const int32_t ccc = get_ccc(full_decomp[index]);
-            if (ccc == 0)
-            {
-                index += 1;
-                continue;
-            }
+    return status;
+}
 
-            // Find the last combining mark in this range of combining marks.
-            unisize end = index + 1;
-            while (end != decomp_length)
+static unistat output_finalize(struct NormOutput *out)
+{
+    unistat status = UNI_OK;
+    if (output_is_deferred(out))
+    {
+        *out->dst_len = 0;
+    }
+    else
+    {
+        status = uni_charbuf_finalize(&out->buffer);
+    }
+    return status;
+}
+
+#if defined(UNICORN_FEATURE_NFC_QUICK_CHECK) || defined(UNICORN_FEATURE_NFD_QUICK_CHECK)
+// Copies the characters from the iterator that are already normalized to the output verbatim and
+// advances the iterator past them. Characters are copied until one whose quick check property isn't
+// 'yes', or a combining mark out of canonical order, is found. The starter preceding it, and the
+// combining marks after that starter, are not copied because they might compose or reorder with it.
+// Normalization resumes from that starter which can begin a run because its quick check property is
+// 'yes' therefore it doesn't compose with the characters before it. Malformed characters are left
+// for the normalization pipeline to report or replace.
+static void copy_normalized_prefix(struct unitext *it, QuickCheckFunc quick_check, struct NormOutput *out)
+{
+    const uniattr encoding = it->encoding & ~UNI_REPLACE; // Malformed characters end the prefix.
+    unisize index = it->index;
+    unisize resume = it->index;
+    int32_t last_ccc = 0;
+
+    for (;;)
+    {
+        const unisize start = index;
+        unichar cp;
+        const unistat status = uni_nextchar(it->data, it->length, encoding, &index, &cp);
+        if (status != UNI_OK)
+        {
+            if (status == UNI_DONE)
             {
-                if (get_ccc(state->decomp.chars[end]) == 0)
-                {
-                    break;
-                }
-                end += 1;
+                resume = start; // Everything up to the end of the text is normalized.
             }
+            break;
+        }
 
-            sort_combining_marks(&full_decomp[index], end - index);
-            index = end;
+        const int32_t ccc = get_ccc(cp);
+        if ((quick_check(cp) != (uint32_t)UNI_YES) || ((ccc != 0) && (last_ccc > ccc)))
+        {
+            break;
         }
 
-        state->r = decomp_length;
+        if (ccc == 0)
+        {
+            resume = start;
+        }
+        last_ccc = ccc;
     }
 
-    return status;
-}
-
-static inline unichar uni_norm_pop(struct NormalizeState *state)
-{
-    assert(!uni_norm_is_empty(state)); // LCOV_EXCL_BR_LINE
-    const unichar ch = state->decomp.chars[state->offset];
-    state->offset += 1;
-    return ch;
+    if (resume > it->index)
+    {
+        // Deferred output skips the characters because they're unchanged.
+        if (!output_is_deferred(out))
+        {
+            uni_charbuf_append_text(&out->buffer, it->data, it->index, resume, it->encoding);
+        }
+        it->index = resume;
+    }
 }
+#endif
 
-static unistat unrom_normalize_decompose(const void *src, unisize src_len, uniattr src_attr, void *dst, unisize *dst_len, uniattr dst_attr)
+static unistat unrom_normalize_decompose(const void *src, unisize src_len, uniattr src_attr, void *dst, unisize *dst_len, uniattr dst_attr, uniworkspace *workspace, bool *changed)
 {
-    struct CharBuf buffer = {NULL};
-    unistat status = uni_charbuf_init(&buffer, dst, dst_len, dst_attr);
+    struct NormOutput out;
+    unistat status = output_init(&out, dst, dst_len, dst_attr, changed);
 
     if (status == UNI_OK)
     {
@@ -566,25 +892,45 @@ static unistat unrom_normalize_decompose(const void *src, unisize src_len, uniat
     if (status == UNI_OK)
     {
         struct NormalizeState state;
-        struct unitext it = {src, 0, src_len, src_attr};
+        struct unitext it = {src, uni_charbuf_resume(&out.buffer, NULL), src_len, src_attr};
 
-        uni_norm_init(&state, &uni_is_stable_nfd);
+        uni_norm_init(&state, &uni_is_stable_nfd, workspace);
         for (;;)
         {
+            // Each run is normalized independently so output can resume from its start.
+            if (uni_charbuf_checkpoint(&out.buffer, it.index, 0))
+            {
+                status = UNI_DONE;
+                break;
+            }
+
+#if defined(UNICORN_FEATURE_NFD_QUICK_CHECK)
+            // Text that's already normalized is copied as-is rather than decomposed.
+            // Resumable output is produced run by run so it can be checkpointed.
+            if (out.buffer.cursor == NULL)
+            {
+                copy_normalized_prefix(&it, &quick_check_NFD, &out);
+            }
+#endif
+
+            const unisize start = it.index;
             status = uni_norm_append_run(&state, &it);
+            if (status == UNI_OK)
+            {
+                status = output_append(&out, &it, start, state.decomp.chars, state.decomp.length);
+            }
+
             if (status != UNI_OK)
             {
                 break;
             }
-
-            uni_charbuf_append(&buffer, state.decomp.chars, state.decomp.length);
             uni_norm_reset(&state);
         }
 
         uni_norm_free(&state);
         if (status == UNI_DONE)
         {
-            status = uni_charbuf_finalize(&buffer);
+            status = output_finalize(&out);
         }
     }
 
@@ -592,10 +938,10 @@ static unistat unrom_normalize_decompose(const void *src, unisize src_len, uniat
 }
 
 #if defined(UNICORN_FEATURE_NFC)
-static unistat unrom_normalize_compose(const void *src, unisize src_len, uniattr src_attr, void *dst, unisize *dst_len, uniattr dst_attr)
+static unistat unrom_normalize_compose(const void *src, unisize src_len, uniattr src_attr, void *dst, unisize *dst_len, uniattr dst_attr, uniworkspace *workspace, bool *changed)
 {
-    struct CharBuf buffer = {NULL};
-    unistat status = uni_charbuf_init(&buffer, dst, dst_len, dst_attr);
+    struct NormOutput out;
+    unistat status = output_init(&out, dst, dst_len, dst_attr, changed);
 
     if (status == UNI_OK)
     {
@@ -605,30 +951,46 @@ static unistat unrom_normalize_compose(const void *src, unisize src_len, uniattr
     if (status == UNI_OK)
     {
         struct NormalizeState state;
-        struct unitext it = {src, 0, src_len, src_attr};
+        struct unitext it = {src, uni_charbuf_resume(&out.buffer, NULL), src_len, src_attr};
 
-        uni_norm_init(&state, &is_stable_nfc);
+        uni_norm_init(&state, &is_stable_nfc, workspace);
         for (;;)
         {
+            // Each run is normalized independently so output can resume from its start.
+            if (uni_charbuf_checkpoint(&out.buffer, it.index, 0))
+            {
+                status = UNI_DONE;
+                break;
+            }
+
+#if defined(UNICORN_FEATURE_NFC_QUICK_CHECK)
+            // Text that's already normalized is copied as-is rather than decomposed and recomposed.
+            // Resumable output is produced run by run so it can be checkpointed.
+            if (out.buffer.cursor == NULL)
+            {
+                copy_normalized_prefix(&it, &quick_check_NFC, &out);
+            }
+#endif
+
+            const unisize start = it.index;
             status = uni_norm_append_run(&state, &it);
             if (status == UNI_OK)
             {
                 norm_compose(&state.decomp);
+                status = output_append(&out, &it, start, state.decomp.chars, state.decomp.length);
             }
 
             if (status != UNI_OK)
             {
                 break;
             }
-
-            uni_charbuf_append(&buffer, state.decomp.chars, state.decomp.length);
             uni_norm_reset(&state);
         }
 
         uni_norm_free(&state);
         if (status == UNI_DONE)
         {
-            status = uni_charbuf_finalize(&buffer);
+            status = output_finalize(&out);
         }
     }
     return status;
@@ -637,7 +999,7 @@ static unistat unrom_normalize_compose(const void *src, unisize src_len, uniattr
 
 #endif
 
-UNICORN_API unistat uni_norm(uninormform form, const void *src, unisize src_len, uniattr src_attr, void *dst, unisize *dst_len, uniattr dst_attr)
+static unistat normalize(uninormform form, const void *src, unisize src_len, uniattr src_attr, void *dst, unisize *dst_len, uniattr dst_attr, uniworkspace *workspace, bool *changed)
 {
     unistat status = UNI_OK;
 
@@ -645,7 +1007,7 @@ UNICORN_API unistat uni_norm(uninormform form, const void *src, unisize src_len,
     {
     case UNI_NFC:
 #if defined(UNICORN_FEATURE_NFC)
-        status = unrom_normalize_compose(src, src_len, src_attr, dst, dst_len, dst_attr);
+        status = unrom_normalize_compose(src, src_len, src_attr, dst, dst_len, dst_attr, workspace, changed);
 #else
         uni_message("feature disabled");
         status = UNI_FEATURE_DISABLED;
@@ -654,7 +1016,7 @@ UNICORN_API unistat uni_norm(uninormform form, const void *src, unisize src_len,
 
     case UNI_NFD:
 #if defined(UNICORN_FEATURE_NFD)
-        status = unrom_normalize_decompose(src, src_len, src_attr, dst, dst_len, dst_attr);
+        status = unrom_normalize_decompose(src, src_len, src_attr, dst, dst_len, dst_attr, workspace, changed);
 #else
         uni_message("feature disabled");
         status = UNI_FEATURE_DISABLED;
@@ -670,6 +1032,31 @@ UNICORN_API unistat uni_norm(uninormform form, const void *src, unisize src_len,
     return status;
 }
 
+UNICORN_API unistat uni_normws(uninormform form, const void *src, unisize src_len, uniattr src_attr, void *dst, unisize *dst_len, uniattr dst_attr, uniworkspace *workspace)
+{
+    return normalize(form, src, src_len, src_attr, dst, dst_len, dst_attr, workspace, NULL);
+}
+
+UNICORN_API unistat uni_normif(uninormform form, const void *src, unisize src_len, uniattr src_attr, void *dst, unisize *dst_len, uniattr dst_attr, bool *changed) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+{
+    unistat status;
+    if (changed == NULL)
+    {
+        uni_message("required argument 'changed' is null");
+        status = UNI_BAD_OPERATION;
+    }
+    else
+    {
+        status = normalize(form, src, src_len, src_attr, dst, dst_len, dst_attr, NULL, changed);
+    }
+    return status;
+}
+
+UNICORN_API unistat uni_norm(uninormform form, const void *src, unisize src_len, uniattr src_attr, void *dst, unisize *dst_len, uniattr dst_attr) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+{
+    return uni_normws(form, src, src_len, src_attr, dst, dst_len, dst_attr, NULL);
+}
+
 UNICORN_API unistat uni_normcmp(const void *s1, unisize s1_len, uniattr s1_attr, const void *s2, unisize s2_len, uniattr s2_attr, bool *result) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
 {
 #if defined(UNICORN_FEATURE_NFD)
@@ -677,8 +1064,8 @@ UNICORN_API unistat uni_normcmp(const void *s1, unisize s1_len, uniattr s1_attr,
     struct NormalizeState ns2;
     unistat status = UNI_OK;
 
-    uni_norm_init(&ns1, &uni_is_stable_nfd);
-    uni_norm_init(&ns2, &uni_is_stable_nfd);
+    uni_norm_init(&ns1, &uni_is_stable_nfd, NULL);
+    uni_norm_init(&ns2, &uni_is_stable_nfd, NULL);
 
     if (result == NULL)
     {
@@ -759,6 +1146,23 @@ UNICORN_API unistat uni_normcmp(const void *s1, unisize s1_len, uniattr s1_attr,
 #endif
 }
 
+UNICORN_API unistat uni_viewnormcmp(const uniview *v1, const uniview *v2, bool *result) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+{
+    unistat status;
+
+    if ((v1 == NULL) || (v2 == NULL))
+    {
+        uni_message("required argument is null");
+        status = UNI_BAD_OPERATION;
+    }
+    else
+    {
+        status = uni_normcmp(v1->text, v1->text_len, v1->text_attr, v2->text, v2->text_len, v2->text_attr, result);
+    }
+
+    return status;
+}
+
 #if defined(UNICORN_FEATURE_NFC_QUICK_CHECK) || defined(UNICORN_FEATURE_NFD_QUICK_CHECK)
 static unistat quick_check(struct unitext input, QuickCheckFunc quick_check, uninormchk *result)
 {
@@ -771,7 +1175,7 @@ static unistat quick_check(struct unitext input, QuickCheckFunc quick_check, uni
     while ((*result) != UNI_NO)
     {
         unichar cp;
-        status = uni_next(input.data, input.length, input.encoding, &index, &cp);
+        status = uni_nextchar(input.data, input.length, input.encoding, &index, &cp);
         if (status != UNI_OK)
         {
             if (status == UNI_DONE)
@@ -803,22 +1207,6 @@ static unistat quick_check(struct unitext input, QuickCheckFunc quick_check, uni
 }
 #endif
 
-#if defined(UNICORN_FEATURE_NFC_QUICK_CHECK)
-static inline uint32_t quick_check_NFC(unichar character)
-{
-    const uint32_t flags = (uint32_t)unicorn_get_codepoint_data(character)->quick_check_flags;
-    return flags >> 4u;
-}
-#endif
-
-#if defined(UNICORN_FEATURE_NFD_QUICK_CHECK)
-static inline uint32_t quick_check_NFD(unichar character)
-{
-    const uint32_t flags = (uint32_t)unicorn_get_codepoint_data(character)->quick_check_flags;
-    return flags & 0xFu;
-}
-#endif
-
 UNICORN_API unistat uni_normqchk(uninormform form, const void *text, unisize text_len, uniattr text_attr, uninormchk *result) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
 {
 #if defined(UNICORN_FEATURE_NFC_QUICK_CHECK) || defined(UNICORN_FEATURE_NFD_QUICK_CHECK)
@@ -925,7 +1313,7 @@ UNICORN_API unistat uni_normchk(uninormform form, const void *text, unisize text
         struct NormalizeState state = {0};
         bool matches = true;
 
-        uni_norm_init(&state, is_stable);
+        uni_norm_init(&state, is_stable, NULL);
         while (matches)
         {
             status = uni_norm_append_run(&state, &it);
@@ -948,7 +1336,7 @@ UNICORN_API unistat uni_normchk(uninormform form, const void *text, unisize text
             while (!uni_norm_is_empty(&state))
             {
                 unichar cp = FIRST_ILLEGAL_CODE_POINT;
-                status = uni_next(copy.data, copy.length, copy.encoding, &copy.index, &cp);
+                status = uni_nextchar(copy.data, copy.length, copy.encoding, &copy.index, &cp);
 
                 // The normalization append run routine already checks the text for malformed characters.
                 // Under no circumstances should a malformed character be detected at this point.
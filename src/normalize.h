@@ -16,6 +16,7 @@
 
 #include "common.h"
 #include "charvec.h"
+#include "unidata.h"
 
 typedef bool (*IsStable)(unichar cp);
 
@@ -26,15 +27,19 @@ struct NormalizeState
     int32_t r;
     IsStable is_stable;
 
-    // Tracks an unstable span of characters within unnormalized text.
-    // This is the span of text that will be normalized.
+    // Upper bound on the decomposed length of a run or zero if runs are unbounded.
+    // Runs are bounded when the heap is disabled so they fit the stack buffers.
+    unisize limit;
+
+    // Characters of the run being normalized. They're only recorded when runs are bounded
+    // so a run that exceeds the limit can be cut short at a character it can end before.
     struct CharVec span;
 
     // Buffer with decomposed characters.
     struct CharVec decomp;
 };
 
-void uni_norm_init(struct NormalizeState *state, IsStable is_stable);
+void uni_norm_init(struct NormalizeState *state, IsStable is_stable, uniworkspace *workspace);
 void uni_norm_free(struct NormalizeState *state);
 
 void uni_norm_reset(struct NormalizeState *ns);
@@ -43,4 +48,9 @@ unistat uni_norm_append_run(struct NormalizeState *state, struct unitext *it);
 
 bool uni_is_stable_nfd(unichar cp);
 
+#if defined(UNICORN_FEATURE_NFD)
+// Writes the full canonical decomposition of the character and returns its length.
+unisize uni_norm_decompose(unichar ch, unichar chars[LONGEST_UNICHAR_DECOMPOSITION]);
+#endif
+
 #endif // NORMALIZE_H
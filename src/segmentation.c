@@ -80,7 +80,7 @@ static inline void state_free(struct MatchContext *ctx, struct RuleState *state)
 static bool at_end(struct unitext text)
 {
     unichar cp;
-    return uni_next(text.data, text.length, text.encoding, &text.index, &cp) == UNI_DONE;
+    return uni_nextchar(text.data, text.length, text.encoding, &text.index, &cp) == UNI_DONE;
 }
 
 static void add_state(struct MatchContext *ctx, struct RuleStateList *list, int32_t ip, struct unitext *text)
@@ -222,7 +222,7 @@ static unistat match(unibreak type, const uint32_t *opcodes, const uint32_t *dat
         unichar cp = UNICORN_LARGEST_CODE_POINT;
         if (direction > 0)
         {
-            status = uni_next(text.data, text.length, text.encoding, &text.index, &cp);
+            status = uni_nextchar(text.data, text.length, text.encoding, &text.index, &cp);
             if (status == UNI_DONE)
             {
                 overflow = true;
@@ -231,7 +231,7 @@ static unistat match(unibreak type, const uint32_t *opcodes, const uint32_t *dat
         }
         else
         {
-            status = uni_prev(text.data, text.length, text.encoding, &text.index, &cp);
+            status = uni_prevchar(text.data, text.length, text.encoding, &text.index, &cp);
             if (status == UNI_DONE)
             {
                 overflow = true;
@@ -367,148 +367,138 @@ static unistat match_rule(unibreak type, const struct BreakRule *rule, const uin
 
 static unistat next_break(unibreak type, const struct Segmentation *seg, const void *text, unisize length, uniattr encoding, unisize *index)
 {
-    unistat status = UNI_OK;
-
-    if (index == NULL)
-    {
-        uni_message("required argument is null");
-        status = UNI_BAD_OPERATION;
-    }
-    else
-    {
-        status = uni_check_input_encoding(text, length, &encoding);
-    }
-
-    if (status == UNI_OK)
+    unistat status;
+    unichar cp;
+    struct unitext it = {text, *index, length, encoding};
+    status = uni_nextchar(it.data, it.length, it.encoding, &it.index, &cp);
+    while (status == UNI_OK)
     {
-        unichar cp;
-        struct unitext it = {text, *index, length, encoding};
-        status = uni_next(it.data, it.length, it.encoding, &it.index, &cp);
-        while (status == UNI_OK)
+        const struct BreakRule *rule = NULL;
+        bool found_match = false;
+        for (int32_t i = 0; i < seg->rules_count; i++) // LCOV_EXCL_BR_LINE: There is always a matching rule (therefore this is never false).
         {
-            const struct BreakRule *rule = NULL;
-            bool found_match = false;
-            for (int32_t i = 0; i < seg->rules_count; i++) // LCOV_EXCL_BR_LINE: There is always a matching rule (therefore this is never false).
+            rule = &seg->rules[i];
+            status = match_rule(type, rule, seg->data, &it, &found_match);
+            if ((status != UNI_OK) || found_match)
             {
-                rule = &seg->rules[i];
-                status = match_rule(type, rule, seg->data, &it, &found_match);
-                if ((status != UNI_OK) || found_match)
-                {
-                    break;
-                }
-            }
-
-            // All segmentation types have a wildcard match rule therefore there
-            // must always be a matching rule. This check is left in place to
-            // guard against future assumptions.
-             // LCOV_EXCL_START
-            if (rule == NULL)
-            {
-                status = UNI_MALFUNCTION;
+                break;
             }
-            // LCOV_EXCL_STOP
+        }
 
-            if (status == UNI_OK)
-            {
-                assert(found_match); // LCOV_EXCL_BR_LINE
-                if (!rule->mandatory_break)
-                {
-                    status = uni_next(text, length, encoding, &it.index, &cp);
-                }
-            }
+        // All segmentation types have a wildcard match rule therefore there
+        // must always be a matching rule. This check is left in place to
+        // guard against future assumptions.
+         // LCOV_EXCL_START
+        if (rule == NULL)
+        {
+            status = UNI_MALFUNCTION;
+        }
+        // LCOV_EXCL_STOP
 
-            if ((status != UNI_OK) || rule->mandatory_break)
+        if (status == UNI_OK)
+        {
+            assert(found_match); // LCOV_EXCL_BR_LINE
+            if (!rule->mandatory_break)
             {
-                break;
+                status = uni_nextchar(text, length, encoding, &it.index, &cp);
             }
         }
 
-        if (status == UNI_OK)
+        if ((status != UNI_OK) || rule->mandatory_break)
         {
-            *index = it.index;
+            break;
         }
     }
 
+    if (status == UNI_OK)
+    {
+        *index = it.index;
+    }
+
     return status;
 }
 
 static unistat previous_break(unibreak type, const struct Segmentation *seg, const void *text, unisize length, uniattr encoding, unisize *index)
 {
-    unistat status = UNI_OK;
-
-    if (index == NULL)
-    {
-        uni_message("required argument is null");
-        status = UNI_BAD_OPERATION;
-    }
-    else
-    {
-        status = uni_check_input_encoding(text, length, &encoding);
-    }
-
-    if (status == UNI_OK)
+    unistat status;
+    unichar cp;
+    struct unitext it = {text, *index, length, encoding};
+    status = uni_prevchar(it.data, it.length, it.encoding, &it.index, &cp);
+    while (status == UNI_OK)
     {
-        unichar cp;
-        struct unitext it = {text, *index, length, encoding};
-        status = uni_prev(it.data, it.length, it.encoding, &it.index, &cp);
-        while (status == UNI_OK)
+        const struct BreakRule *rule = NULL;
+        bool found_match = false;
+        for (int32_t i = 0; i < seg->rules_count; i++) // LCOV_EXCL_BR_LINE: There is always a matching rule (therefore this is never false).
         {
-            const struct BreakRule *rule = NULL;
-            bool found_match = false;
-            for (int32_t i = 0; i < seg->rules_count; i++) // LCOV_EXCL_BR_LINE: There is always a matching rule (therefore this is never false).
+            rule = &seg->rules[i];
+            status = match_rule(type, rule, seg->data, &it, &found_match);
+            if ((status != UNI_OK) || found_match)
             {
-                rule = &seg->rules[i];
-                status = match_rule(type, rule, seg->data, &it, &found_match);
-                if ((status != UNI_OK) || found_match)
-                {
-                    break;
-                }
-            }
-
-            // All segmentation types have a wildcard match rule therefore there
-            // must always be a matching rule. This check is left in place to
-            // guard against future assumptions.
-             // LCOV_EXCL_START
-            if (rule == NULL)
-            {
-                status = UNI_MALFUNCTION;
+                break;
             }
-            // LCOV_EXCL_STOP
+        }
 
-            if (status == UNI_OK)
-            {
-                assert(found_match); // LCOV_EXCL_BR_LINE
-                if (!rule->mandatory_break)
-                {
-                    status = uni_prev(text, length, encoding, &it.index, &cp);
-                }
-            }
+        // All segmentation types have a wildcard match rule therefore there
+        // must always be a matching rule. This check is left in place to
+        // guard against future assumptions.
+         // LCOV_EXCL_START
+        if (rule == NULL)
+        {
+            status = UNI_MALFUNCTION;
+        }
+        // LCOV_EXCL_STOP
 
-            if ((status != UNI_OK) || rule->mandatory_break)
+        if (status == UNI_OK)
+        {
+            assert(found_match); // LCOV_EXCL_BR_LINE
+            if (!rule->mandatory_break)
             {
-                break;
+                status = uni_prevchar(text, length, encoding, &it.index, &cp);
             }
         }
 
-        if (status == UNI_OK)
+        if ((status != UNI_OK) || rule->mandatory_break)
         {
-            *index = it.index;
+            break;
         }
     }
 
+    if (status == UNI_OK)
+    {
+        *index = it.index;
+    }
+
+    return status;
+}
+
+static unistat check_break_arguments(const void *text, unisize text_len, uniattr *text_attr, const unisize *index)
+{
+    unistat status;
+    if (index == NULL)
+    {
+        uni_message("required argument is null");
+        status = UNI_BAD_OPERATION;
+    }
+    else
+    {
+        status = uni_check_input_encoding(text, text_len, text_attr);
+    }
     return status;
 }
 
 #endif
 
-UNICORN_API unistat uni_nextbrk(unibreak boundary, const void *text, unisize text_len, uniattr text_attr, unisize *index)
+// The structure is only defined by the generated tables when segmentation is enabled.
+struct Segmentation;
+
+static unistat get_segmentation(unibreak boundary, const struct Segmentation **seg)
 {
-    unistat status;
+    unistat status = UNI_OK;
     switch (boundary)
     {
     case UNI_GRAPHEME:
 #if defined(UNICORN_FEATURE_GCB)
-        status = next_break(boundary, &uni_gcb, text, text_len, text_attr, index);
+        *seg = &uni_gcb;
 #else
         status = UNI_FEATURE_DISABLED;
         uni_message("extended grapheme cluster break disabled");
@@ -517,7 +507,7 @@ UNICORN_API unistat uni_nextbrk(unibreak boundary, const void *text, unisize tex
 
     case UNI_WORD:
 #if defined(UNICORN_FEATURE_WB)
-        status = next_break(boundary, &uni_wb, text, text_len, text_attr, index);
+        *seg = &uni_wb;
 #else
         status = UNI_FEATURE_DISABLED;
         uni_message("word break disabled");
@@ -526,7 +516,7 @@ UNICORN_API unistat uni_nextbrk(unibreak boundary, const void *text, unisize tex
 
     case UNI_SENTENCE:
 #if defined(UNICORN_FEATURE_SB)
-        status = next_break(boundary, &uni_sb, text, text_len, text_attr, index);
+        *seg = &uni_sb;
 #else
         status = UNI_FEATURE_DISABLED;
         uni_message("sentence break disabled");
@@ -541,42 +531,88 @@ UNICORN_API unistat uni_nextbrk(unibreak boundary, const void *text, unisize tex
     return status;
 }
 
-UNICORN_API unistat uni_prevbrk(unibreak boundary, const void *text, unisize text_len, uniattr text_attr, unisize *index) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+UNICORN_API unistat uni_nextbrk(unibreak boundary, const void *text, unisize text_len, uniattr text_attr, unisize *index)
 {
-    unistat status;
-    switch (boundary)
+    const struct Segmentation *seg = NULL;
+    unistat status = get_segmentation(boundary, &seg);
+
+#if defined(UNICORN_FEATURE_SEGMENTATION)
+    if (status == UNI_OK)
     {
-    case UNI_GRAPHEME:
-#if defined(UNICORN_FEATURE_GCB)
-        status = previous_break(boundary, &uni_gcb, text, text_len, text_attr, index);
-#else
-        status = UNI_FEATURE_DISABLED;
-        uni_message("extended grapheme cluster break disabled");
+        status = check_break_arguments(text, text_len, &text_attr, index);
+    }
+
+    if (status == UNI_OK)
+    {
+        status = next_break(boundary, seg, text, text_len, text_attr, index);
+    }
 #endif
-        break;
 
-    case UNI_WORD:
-#if defined(UNICORN_FEATURE_WB)
-        status = previous_break(boundary, &uni_wb, text, text_len, text_attr, index);
-#else
-        status = UNI_FEATURE_DISABLED;
-        uni_message("word break disabled");
+    return status;
+}
+
+UNICORN_API unistat uni_prevbrk(unibreak boundary, const void *text, unisize text_len, uniattr text_attr, unisize *index) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+{
+    const struct Segmentation *seg = NULL;
+    unistat status = get_segmentation(boundary, &seg);
+
+#if defined(UNICORN_FEATURE_SEGMENTATION)
+    if (status == UNI_OK)
+    {
+        status = check_break_arguments(text, text_len, &text_attr, index);
+    }
+
+    if (status == UNI_OK)
+    {
+        status = previous_break(boundary, seg, text, text_len, text_attr, index);
+    }
 #endif
-        break;
 
-    case UNI_SENTENCE:
-#if defined(UNICORN_FEATURE_SB)
-        status = previous_break(boundary, &uni_sb, text, text_len, text_attr, index);
-#else
-        status = UNI_FEATURE_DISABLED;
-        uni_message("sentence break disabled");
+    return status;
+}
+
+UNICORN_API unistat uni_viewnextbrk(unibreak boundary, const uniview *view, unisize *index) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+{
+    const struct Segmentation *seg = NULL;
+    unistat status = get_segmentation(boundary, &seg);
+
+#if defined(UNICORN_FEATURE_SEGMENTATION)
+    if (status == UNI_OK)
+    {
+        if ((view == NULL) || (index == NULL))
+        {
+            uni_message("required argument is null");
+            status = UNI_BAD_OPERATION;
+        }
+        else
+        {
+            status = next_break(boundary, seg, view->text, view->text_len, view->text_attr, index);
+        }
+    }
 #endif
-        break;
 
-    default:
-        uni_message("illegal break argument");
-        status = UNI_BAD_OPERATION;
-        break;
+    return status;
+}
+
+UNICORN_API unistat uni_viewprevbrk(unibreak boundary, const uniview *view, unisize *index) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+{
+    const struct Segmentation *seg = NULL;
+    unistat status = get_segmentation(boundary, &seg);
+
+#if defined(UNICORN_FEATURE_SEGMENTATION)
+    if (status == UNI_OK)
+    {
+        if ((view == NULL) || (index == NULL))
+        {
+            uni_message("required argument is null");
+            status = UNI_BAD_OPERATION;
+        }
+        else
+        {
+            status = previous_break(boundary, seg, view->text, view->text_len, view->text_attr, index);
+        }
     }
+#endif
+
     return status;
 }
@@ -0,0 +1,1850 @@
+/*
+ *  Unicorn - Embeddable Unicode Algorithms
+ *  Copyright (c) 2024-2026 Railgun Labs
+ *
+ *  This software is dual-licensed: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation. For the terms of this
+ *  license, see <https://www.gnu.org/licenses/>.
+ *
+ *  Alternatively, you can license this software under a proprietary
+ *  license, as set out in <https://railgunlabs.com/unicorn/license/>.
+ */
+
+#include "simd.h"
+#include "byteswap.h"
+
+#if defined(UNICORN_HAVE_X86_SIMD)
+
+#include <immintrin.h>
+
+/*
+ *  The vectorized UTF-8 validator is based on the lookup algorithm described in
+ *  "Validating UTF-8 In Less Than One Instruction Per Byte" by John Keiser and
+ *  Daniel Lemire. Each byte is classified together with the byte preceding it
+ *  using three 16 entry lookup tables indexed by nibbles. The tables are built
+ *  such that the bitwise AND of the three lookups is non-zero if, and only if,
+ *  the pair of bytes forms an illegal two byte pattern. Errors that require
+ *  looking three or four bytes back are detected by verifying that the third
+ *  and fourth bytes of multi-byte sequences are continuation bytes.
+ */
+#define TOO_SHORT      ((uint8_t)0x01) // 11______ 0_______ or 11______ 11______
+#define TOO_LONG       ((uint8_t)0x02) // 0_______ 10______
+#define OVERLONG_3     ((uint8_t)0x04) // 11100000 100_____
+#define TOO_LARGE      ((uint8_t)0x08) // 11110100 1001____ (and higher)
+#define SURROGATE      ((uint8_t)0x10) // 11101101 101_____
+#define OVERLONG_2     ((uint8_t)0x20) // 1100000_ 10______
+#define TOO_LARGE_1000 ((uint8_t)0x40) // 11110101 1000____ (and higher)
+#define OVERLONG_4     ((uint8_t)0x40) // 11110000 1000____
+#define TWO_CONTS      ((uint8_t)0x80) // 10______ 10______
+#define CARRY          (TOO_SHORT | TOO_LONG | TWO_CONTS)
+
+// Indexed by the high nibble of the first byte.
+static const uint8_t byte_1_high[] = {
+    // 0_______ ________ <ASCII in byte 1>
+    TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+    TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+    // 10______ ________ <continuation in byte 1>
+    TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+    // 1100____ ________ <two byte lead in byte 1>
+    TOO_SHORT | OVERLONG_2,
+    // 1101____ ________ <two byte lead in byte 1>
+    TOO_SHORT,
+    // 1110____ ________ <three byte lead in byte 1>
+    TOO_SHORT | OVERLONG_3 | SURROGATE,
+    // 1111____ ________ <four+ byte lead in byte 1>
+    TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4,
+};
+
+// Indexed by the low nibble of the first byte.
+static const uint8_t byte_1_low[] = {
+    CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4, // ____0000 ________
+    CARRY | OVERLONG_2,                           // ____0001 ________
+    CARRY,                                        // ____001_ ________
+    CARRY,
+    CARRY | TOO_LARGE,                            // ____0100 ________
+    CARRY | TOO_LARGE | TOO_LARGE_1000,           // ____0101 ________
+    CARRY | TOO_LARGE | TOO_LARGE_1000,           // ____011_ ________
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,           // ____1___ ________
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE, // ____1101 ________
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+};
+
+// Indexed by the high nibble of the second byte.
+static const uint8_t byte_2_high[] = {
+    // ________ 0_______ <ASCII in byte 2>
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+    // ________ 1000____
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+    // ________ 1001____
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+    // ________ 101_____
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+    // ________ 11______
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+};
+
+// Largest byte value permitted in each position at the end of a block
+// without the block ending in the middle of a multi-byte sequence.
+static const uint8_t incomplete_max[] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xEF, 0xDF, 0xBF,
+};
+
+// Moves the offset backward to the first byte of a trailing multi-byte sequence
+// that was cut off by the end of the last block. The bytes prior to 'offset' are
+// assumed to be well-formed UTF-8, except for the cut off sequence.
+static unisize UTF8_boundary(const unichar8 *bytes, unisize offset)
+{
+    unisize boundary = offset;
+    for (unisize i = 1; (i <= 3) && (i <= offset); i++)
+    {
+        const uint8_t byte = bytes[offset - i];
+        if (byte < (uint8_t)0x80)
+        {
+            break;
+        }
+        else if (byte >= (uint8_t)0xC0)
+        {
+            unisize needed = 2;
+            if (byte >= (uint8_t)0xF0)
+            {
+                needed = 4;
+            }
+            else if (byte >= (uint8_t)0xE0)
+            {
+                needed = 3;
+            }
+            else
+            {
+                // No Action.
+            }
+
+            if (needed > i)
+            {
+                boundary = offset - i;
+            }
+            break;
+        }
+        else
+        {
+            // No Action: continuation byte.
+        }
+    }
+    return boundary;
+}
+
+UNICORN_TARGET("sse4.2")
+static __m128i sse42_check_block(__m128i input, __m128i prev_input)
+{
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i prev1 = _mm_alignr_epi8(input, prev_input, 15);
+    const __m128i prev2 = _mm_alignr_epi8(input, prev_input, 14);
+    const __m128i prev3 = _mm_alignr_epi8(input, prev_input, 13);
+
+    const __m128i b1h = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)byte_1_high), _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble));
+    const __m128i b1l = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)byte_1_low), _mm_and_si128(prev1, nibble));
+    const __m128i b2h = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)byte_2_high), _mm_and_si128(_mm_srli_epi16(input, 4), nibble));
+    const __m128i special_cases = _mm_and_si128(_mm_and_si128(b1h, b1l), b2h);
+
+    // Only 111_____ and 1111____ will be >= 0x80 after subtraction.
+    const __m128i is_third_byte = _mm_subs_epu8(prev2, _mm_set1_epi8(0xE0 - 0x80));
+    const __m128i is_fourth_byte = _mm_subs_epu8(prev3, _mm_set1_epi8(0xF0 - 0x80));
+    const __m128i must_be_continuation = _mm_and_si128(_mm_or_si128(is_third_byte, is_fourth_byte), _mm_set1_epi8((char)0x80));
+    return _mm_xor_si128(must_be_continuation, special_cases);
+}
+
+UNICORN_TARGET("sse4.2")
+unisize uni_UTF8_valid_prefix_sse42(const unichar8 *bytes, unisize length)
+{
+    const __m128i max_value = _mm_loadu_si128((const __m128i *)&incomplete_max[16]);
+    __m128i prev_input = _mm_setzero_si128();
+    __m128i prev_incomplete = _mm_setzero_si128();
+    unisize offset = 0;
+
+    while ((length - offset) >= 16)
+    {
+        const __m128i input = _mm_loadu_si128((const __m128i *)&bytes[offset]);
+        __m128i error;
+
+        // Blocks of pure ASCII are only invalid if the prior block ended
+        // with an incomplete multi-byte sequence.
+        if (_mm_movemask_epi8(input) == 0)
+        {
+            error = prev_incomplete;
+            prev_incomplete = _mm_setzero_si128();
+        }
+        else
+        {
+            error = sse42_check_block(input, prev_input);
+            prev_incomplete = _mm_subs_epu8(input, max_value);
+        }
+
+        if (_mm_testz_si128(error, error) == 0)
+        {
+            break;
+        }
+
+        prev_input = input;
+        offset += 16;
+    }
+
+    return UTF8_boundary(bytes, offset);
+}
+
+UNICORN_TARGET("avx2")
+static __m256i avx2_check_block(__m256i input, __m256i prev_input)
+{
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const __m256i shifted = _mm256_permute2x128_si256(prev_input, input, 0x21);
+    const __m256i prev1 = _mm256_alignr_epi8(input, shifted, 15);
+    const __m256i prev2 = _mm256_alignr_epi8(input, shifted, 14);
+    const __m256i prev3 = _mm256_alignr_epi8(input, shifted, 13);
+
+    const __m256i b1h = _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)byte_1_high)), _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble));
+    const __m256i b1l = _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)byte_1_low)), _mm256_and_si256(prev1, nibble));
+    const __m256i b2h = _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)byte_2_high)), _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble));
+    const __m256i special_cases = _mm256_and_si256(_mm256_and_si256(b1h, b1l), b2h);
+
+    // Only 111_____ and 1111____ will be >= 0x80 after subtraction.
+    const __m256i is_third_byte = _mm256_subs_epu8(prev2, _mm256_set1_epi8(0xE0 - 0x80));
+    const __m256i is_fourth_byte = _mm256_subs_epu8(prev3, _mm256_set1_epi8(0xF0 - 0x80));
+    const __m256i must_be_continuation = _mm256_and_si256(_mm256_or_si256(is_third_byte, is_fourth_byte), _mm256_set1_epi8((char)0x80));
+    return _mm256_xor_si256(must_be_continuation, special_cases);
+}
+
+UNICORN_TARGET("avx2")
+unisize uni_UTF8_valid_prefix_avx2(const unichar8 *bytes, unisize length)
+{
+    const __m256i max_value = _mm256_loadu_si256((const __m256i *)incomplete_max);
+    __m256i prev_input = _mm256_setzero_si256();
+    __m256i prev_incomplete = _mm256_setzero_si256();
+    unisize offset = 0;
+
+    while ((length - offset) >= 32)
+    {
+        const __m256i input = _mm256_loadu_si256((const __m256i *)&bytes[offset]);
+        __m256i error;
+
+        // Blocks of pure ASCII are only invalid if the prior block ended
+        // with an incomplete multi-byte sequence.
+        if (_mm256_movemask_epi8(input) == 0)
+        {
+            error = prev_incomplete;
+            prev_incomplete = _mm256_setzero_si256();
+        }
+        else
+        {
+            error = avx2_check_block(input, prev_input);
+            prev_incomplete = _mm256_subs_epu8(input, max_value);
+        }
+
+        if (_mm256_testz_si256(error, error) == 0)
+        {
+            break;
+        }
+
+        prev_input = input;
+        offset += 32;
+    }
+
+    return UTF8_boundary(bytes, offset);
+}
+
+unisize uni_ASCII_widen_sse2(const unichar8 *bytes, unisize length, unichar *chars)
+{
+    const __m128i zero = _mm_setzero_si128();
+    unisize count = 0;
+
+    while ((length - count) >= 16)
+    {
+        const __m128i input = _mm_loadu_si128((const __m128i *)&bytes[count]);
+        if (_mm_movemask_epi8(input) != 0)
+        {
+            break;
+        }
+
+        const __m128i lo = _mm_unpacklo_epi8(input, zero);
+        const __m128i hi = _mm_unpackhi_epi8(input, zero);
+        _mm_storeu_si128((__m128i *)&chars[count + 0], _mm_unpacklo_epi16(lo, zero));
+        _mm_storeu_si128((__m128i *)&chars[count + 4], _mm_unpackhi_epi16(lo, zero));
+        _mm_storeu_si128((__m128i *)&chars[count + 8], _mm_unpacklo_epi16(hi, zero));
+        _mm_storeu_si128((__m128i *)&chars[count + 12], _mm_unpackhi_epi16(hi, zero));
+        count += 16;
+    }
+
+    return count + uni_ASCII_widen_scalar(&bytes[count], length - count, &chars[count]);
+}
+
+unisize uni_ASCII_to_UTF16_sse2(const unichar8 *bytes, unisize length, unichar16 *words, bool is_big)
+{
+    const __m128i zero = _mm_setzero_si128();
+    unisize count = 0;
+
+    while ((length - count) >= 16)
+    {
+        const __m128i input = _mm_loadu_si128((const __m128i *)&bytes[count]);
+        if (_mm_movemask_epi8(input) != 0)
+        {
+            break;
+        }
+
+        // Interleaving zeros before each byte produces big endian code units.
+        if (is_big)
+        {
+            _mm_storeu_si128((__m128i *)&words[count + 0], _mm_unpacklo_epi8(zero, input));
+            _mm_storeu_si128((__m128i *)&words[count + 8], _mm_unpackhi_epi8(zero, input));
+        }
+        else
+        {
+            _mm_storeu_si128((__m128i *)&words[count + 0], _mm_unpacklo_epi8(input, zero));
+            _mm_storeu_si128((__m128i *)&words[count + 8], _mm_unpackhi_epi8(input, zero));
+        }
+        count += 16;
+    }
+
+    return count + uni_ASCII_to_UTF16_scalar(&bytes[count], length - count, &words[count], is_big);
+}
+
+unisize uni_UTF16_to_ASCII_sse2(const unichar16 *words, unisize length, unichar8 *bytes, bool is_big)
+{
+    // Code units are loaded in little endian byte order, therefore for big endian
+    // text the bits that must be clear for ASCII characters are byte swapped.
+    const __m128i non_ASCII = is_big ? _mm_set1_epi16((short)0x80FF) : _mm_set1_epi16((short)0xFF80);
+    unisize count = 0;
+
+    while ((length - count) >= 16)
+    {
+        __m128i lo = _mm_loadu_si128((const __m128i *)&words[count + 0]);
+        __m128i hi = _mm_loadu_si128((const __m128i *)&words[count + 8]);
+        const __m128i high_bits = _mm_and_si128(_mm_or_si128(lo, hi), non_ASCII);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(high_bits, _mm_setzero_si128())) != 0xFFFF)
+        {
+            break;
+        }
+
+        if (is_big)
+        {
+            lo = _mm_srli_epi16(lo, 8);
+            hi = _mm_srli_epi16(hi, 8);
+        }
+        _mm_storeu_si128((__m128i *)&bytes[count], _mm_packus_epi16(lo, hi));
+        count += 16;
+    }
+
+    return count + uni_UTF16_to_ASCII_scalar(&words[count], length - count, &bytes[count], is_big);
+}
+
+unisize uni_ASCII_prefix_sse2(const unichar8 *bytes, unisize length)
+{
+    unisize count = 0;
+
+    while ((length - count) >= 16)
+    {
+        const __m128i input = _mm_loadu_si128((const __m128i *)&bytes[count]);
+        if (_mm_movemask_epi8(input) != 0)
+        {
+            break;
+        }
+        count += 16;
+    }
+
+    return count + uni_ASCII_prefix_scalar(&bytes[count], length - count);
+}
+
+unisize uni_LATIN1_widen_sse2(const unichar8 *bytes, unisize length, unichar *chars)
+{
+    const __m128i zero = _mm_setzero_si128();
+    unisize count = 0;
+
+    while ((length - count) >= 16)
+    {
+        const __m128i input = _mm_loadu_si128((const __m128i *)&bytes[count]);
+        const __m128i lo = _mm_unpacklo_epi8(input, zero);
+        const __m128i hi = _mm_unpackhi_epi8(input, zero);
+        _mm_storeu_si128((__m128i *)&chars[count + 0], _mm_unpacklo_epi16(lo, zero));
+        _mm_storeu_si128((__m128i *)&chars[count + 4], _mm_unpackhi_epi16(lo, zero));
+        _mm_storeu_si128((__m128i *)&chars[count + 8], _mm_unpacklo_epi16(hi, zero));
+        _mm_storeu_si128((__m128i *)&chars[count + 12], _mm_unpackhi_epi16(hi, zero));
+        count += 16;
+    }
+
+    return count + uni_LATIN1_widen_scalar(&bytes[count], length - count, &chars[count]);
+}
+
+unisize uni_LATIN1_to_UTF16_sse2(const unichar8 *bytes, unisize length, unichar16 *words, bool is_big)
+{
+    const __m128i zero = _mm_setzero_si128();
+    unisize count = 0;
+
+    while ((length - count) >= 16)
+    {
+        const __m128i input = _mm_loadu_si128((const __m128i *)&bytes[count]);
+
+        // Interleaving zeros before each byte produces big endian code units.
+        if (is_big)
+        {
+            _mm_storeu_si128((__m128i *)&words[count + 0], _mm_unpacklo_epi8(zero, input));
+            _mm_storeu_si128((__m128i *)&words[count + 8], _mm_unpackhi_epi8(zero, input));
+        }
+        else
+        {
+            _mm_storeu_si128((__m128i *)&words[count + 0], _mm_unpacklo_epi8(input, zero));
+            _mm_storeu_si128((__m128i *)&words[count + 8], _mm_unpackhi_epi8(input, zero));
+        }
+        count += 16;
+    }
+
+    return count + uni_LATIN1_to_UTF16_scalar(&bytes[count], length - count, &words[count], is_big);
+}
+
+unisize uni_UTF16_to_LATIN1_sse2(const unichar16 *words, unisize length, unichar8 *bytes, bool is_big)
+{
+    // Code units are loaded in little endian byte order, therefore for big endian
+    // text the byte that must be clear for ISO-8859-1 characters is the low byte.
+    const __m128i high_byte = is_big ? _mm_set1_epi16((short)0x00FF) : _mm_set1_epi16((short)0xFF00);
+    unisize count = 0;
+
+    while ((length - count) >= 16)
+    {
+        __m128i lo = _mm_loadu_si128((const __m128i *)&words[count + 0]);
+        __m128i hi = _mm_loadu_si128((const __m128i *)&words[count + 8]);
+        const __m128i high_bits = _mm_and_si128(_mm_or_si128(lo, hi), high_byte);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(high_bits, _mm_setzero_si128())) != 0xFFFF)
+        {
+            break;
+        }
+
+        if (is_big)
+        {
+            lo = _mm_srli_epi16(lo, 8);
+            hi = _mm_srli_epi16(hi, 8);
+        }
+        _mm_storeu_si128((__m128i *)&bytes[count], _mm_packus_epi16(lo, hi));
+        count += 16;
+    }
+
+    return count + uni_UTF16_to_LATIN1_scalar(&words[count], length - count, &bytes[count], is_big);
+}
+
+unisize uni_LATIN1_to_UTF8_sse2(const unichar8 *bytes, unisize length, unichar8 *out, unisize capacity, unisize *written)
+{
+    // As signed integers the bytes 0x80 through 0x9F are the only ones less than 0xA0.
+    const __m128i c1_limit = _mm_set1_epi8((char)0xA0);
+    unisize count = 0;
+    unisize n = 0;
+
+    // Each block expands to at most 32 bytes.
+    while (((length - count) >= 16) && ((capacity - n) >= 32))
+    {
+        const __m128i input = _mm_loadu_si128((const __m128i *)&bytes[count]);
+        if (_mm_movemask_epi8(input) == 0)
+        {
+            _mm_storeu_si128((__m128i *)&out[n], input);
+            count += 16;
+            n += 16;
+        }
+        else if (_mm_movemask_epi8(_mm_cmplt_epi8(input, c1_limit)) != 0)
+        {
+            break; // The block contains a C1 control byte.
+        }
+        else
+        {
+            // Expand the block without branching on each byte: both bytes of a two byte sequence
+            // are always stored, but the output only advances past the second one when needed.
+            for (unisize i = 0; i < 16; i++)
+            {
+                const unichar8 byte = bytes[count + i];
+                const unisize is_high = (unisize)(byte >> 7u);
+                out[n + 0] = (is_high != 0) ? ((unichar8)(byte >> 6u) | (uint8_t)0xC0) : byte;
+                out[n + 1] = (unichar8)(byte & (uint8_t)0x3F) | (uint8_t)0x80;
+                n += 1 + is_high;
+            }
+            count += 16;
+        }
+    }
+
+    unisize tail_written = 0;
+    count += uni_LATIN1_to_UTF8_scalar(&bytes[count], length - count, &out[n], capacity - n, &tail_written);
+    *written = n + tail_written;
+    return count;
+}
+
+unisize uni_UTF8_to_LATIN1_sse2(const unichar8 *bytes, unisize length, unichar8 *out, unisize *consumed)
+{
+    unisize count = 0;
+    unisize n = 0;
+
+    while ((length - count) >= 16)
+    {
+        const __m128i input = _mm_loadu_si128((const __m128i *)&bytes[count]);
+        if (_mm_movemask_epi8(input) == 0)
+        {
+            _mm_storeu_si128((__m128i *)&out[n], input);
+            count += 16;
+            n += 16;
+        }
+        else
+        {
+            // Blocks with non-ASCII characters contract to a variable length.
+            unisize block_consumed = 0;
+            const unisize block_written = uni_UTF8_to_LATIN1_scalar(&bytes[count], 16, &out[n], &block_consumed);
+            count += block_consumed;
+            n += block_written;
+            if (block_consumed < 15)
+            {
+                break; // A sequence may straddle the block therefore up to one byte can remain.
+            }
+        }
+    }
+
+    unisize tail_consumed = 0;
+    n += uni_UTF8_to_LATIN1_scalar(&bytes[count], length - count, &out[n], &tail_consumed);
+    *consumed = count + tail_consumed;
+    return n;
+}
+
+// Shuffle masks that pack the 16-bit lanes, among the first four, selected by the bits
+// of the index to the front of the vector.
+static const uint8_t pack_words[16][8] = {
+    {0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0x00, 0x01, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0x02, 0x03, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0x00, 0x01, 0x02, 0x03, 0x80, 0x80, 0x80, 0x80},
+    {0x04, 0x05, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0x00, 0x01, 0x04, 0x05, 0x80, 0x80, 0x80, 0x80},
+    {0x02, 0x03, 0x04, 0x05, 0x80, 0x80, 0x80, 0x80},
+    {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x80, 0x80},
+    {0x06, 0x07, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    {0x00, 0x01, 0x06, 0x07, 0x80, 0x80, 0x80, 0x80},
+    {0x02, 0x03, 0x06, 0x07, 0x80, 0x80, 0x80, 0x80},
+    {0x00, 0x01, 0x02, 0x03, 0x06, 0x07, 0x80, 0x80},
+    {0x04, 0x05, 0x06, 0x07, 0x80, 0x80, 0x80, 0x80},
+    {0x00, 0x01, 0x04, 0x05, 0x06, 0x07, 0x80, 0x80},
+    {0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x80, 0x80},
+    {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07},
+};
+
+// Shuffle masks that pack the first four 16-bit lanes, with the first byte of each lane
+// and the second byte of the lanes selected by the bits of the index, to the front of the
+// vector. The selected lanes hold two byte UTF-8 sequences.
+static const uint8_t pack_pairs[16][8] = {
+    {0x00, 0x02, 0x04, 0x06, 0x80, 0x80, 0x80, 0x80},
+    {0x00, 0x01, 0x02, 0x04, 0x06, 0x80, 0x80, 0x80},
+    {0x00, 0x02, 0x03, 0x04, 0x06, 0x80, 0x80, 0x80},
+    {0x00, 0x01, 0x02, 0x03, 0x04, 0x06, 0x80, 0x80},
+    {0x00, 0x02, 0x04, 0x05, 0x06, 0x80, 0x80, 0x80},
+    {0x00, 0x01, 0x02, 0x04, 0x05, 0x06, 0x80, 0x80},
+    {0x00, 0x02, 0x03, 0x04, 0x05, 0x06, 0x80, 0x80},
+    {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x80},
+    {0x00, 0x02, 0x04, 0x06, 0x07, 0x80, 0x80, 0x80},
+    {0x00, 0x01, 0x02, 0x04, 0x06, 0x07, 0x80, 0x80},
+    {0x00, 0x02, 0x03, 0x04, 0x06, 0x07, 0x80, 0x80},
+    {0x00, 0x01, 0x02, 0x03, 0x04, 0x06, 0x07, 0x80},
+    {0x00, 0x02, 0x04, 0x05, 0x06, 0x07, 0x80, 0x80},
+    {0x00, 0x01, 0x02, 0x04, 0x05, 0x06, 0x07, 0x80},
+    {0x00, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x80},
+    {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07},
+};
+
+// Number of bits set in each four bit value.
+static const uint8_t nibble_bits[16] = {0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4};
+
+static inline __m128i sse2_bswap16(__m128i v)
+{
+    return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+}
+
+// Widens a block of 16 ASCII characters to UTF-16 code units in the specified byte order.
+static inline void sse2_store_ASCII_as_UTF16(__m128i input, unichar16 *words, bool is_big)
+{
+    const __m128i zero = _mm_setzero_si128();
+    if (is_big)
+    {
+        _mm_storeu_si128((__m128i *)&words[0], _mm_unpacklo_epi8(zero, input));
+        _mm_storeu_si128((__m128i *)&words[8], _mm_unpackhi_epi8(zero, input));
+    }
+    else
+    {
+        _mm_storeu_si128((__m128i *)&words[0], _mm_unpacklo_epi8(input, zero));
+        _mm_storeu_si128((__m128i *)&words[8], _mm_unpackhi_epi8(input, zero));
+    }
+}
+
+unisize uni_UTF8_to_UTF16_sse2(const unichar8 *bytes, unisize length, unichar16 *words, unisize capacity, bool is_big, unisize *written)
+{
+    unisize count = 0;
+    unisize n = 0;
+
+    for (;;)
+    {
+        // Runs of ASCII characters are transcoded in bulk. Each byte is a code unit
+        // therefore the text and buffer advance in lockstep.
+        if ((count < length) && (bytes[count] < (uint8_t)0x80))
+        {
+            const unisize available = ((length - count) < (capacity - n)) ? (length - count) : (capacity - n);
+            const unisize run = uni_ASCII_to_UTF16_sse2(&bytes[count], available, &words[n], is_big);
+            count += run;
+            n += run;
+        }
+
+        // Each block expands to at most 16 code units.
+        if (((length - count) < 16) || ((capacity - n) < 16))
+        {
+            break;
+        }
+
+        unisize block_written = 0;
+        const unisize block_consumed = uni_UTF8_to_UTF16_scalar(&bytes[count], 16, &words[n], capacity - n, is_big, &block_written);
+        count += block_consumed;
+        n += block_written;
+        if (block_consumed < 13)
+        {
+            break; // A sequence may straddle the block therefore up to three bytes can remain.
+        }
+    }
+
+    unisize tail_written = 0;
+    count += uni_UTF8_to_UTF16_scalar(&bytes[count], length - count, &words[n], capacity - n, is_big, &tail_written);
+    *written = n + tail_written;
+    return count;
+}
+
+// Transcodes the characters of a block of well-formed UTF-8 without four byte sequences
+// that end within the block. The first byte of the block must begin a character. The
+// number of code units written to 'words' is stored in 'written'. The code units are
+// packed with whole stores therefore up to 16 code units are stored, which is up to four
+// past the transcoded ones. Returns the number of bytes transcoded.
+UNICORN_TARGET("sse4.2")
+static unisize sse42_UTF8_block_to_UTF16(const unichar8 *bytes, __m128i input, unichar16 *words, bool is_big, unisize *written)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i low_6_bits = _mm_set1_epi16(0x3F);
+    const __m128i next_1 = _mm_srli_si128(input, 1);
+    const __m128i next_2 = _mm_srli_si128(input, 2);
+
+    // Characters are only transcoded if all of their bytes are in the block.
+    const unisize end = UTF8_boundary(bytes, 16);
+    const uint32_t continuations = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(input, _mm_set1_epi8((char)0xC0)), _mm_set1_epi8((char)0x80)));
+    const uint32_t leads = ~continuations & ((1u << (uint32_t)end) - 1u);
+
+    unisize n = 0;
+    for (uint32_t half = 0; half < 2u; half++)
+    {
+        // Each 16-bit lane holds one byte of the block together with the two bytes following it.
+        __m128i current;
+        __m128i second;
+        __m128i third;
+        if (half == 0)
+        {
+            current = _mm_unpacklo_epi8(input, zero);
+            second = _mm_and_si128(_mm_unpacklo_epi8(next_1, zero), low_6_bits);
+            third = _mm_and_si128(_mm_unpacklo_epi8(next_2, zero), low_6_bits);
+        }
+        else
+        {
+            current = _mm_unpackhi_epi8(input, zero);
+            second = _mm_and_si128(_mm_unpackhi_epi8(next_1, zero), low_6_bits);
+            third = _mm_and_si128(_mm_unpackhi_epi8(next_2, zero), low_6_bits);
+        }
+
+        // Decode every lane as if it begins a two and a three byte sequence and select the
+        // value matching its lead byte. Shifting by 12 discards all but the low four bits.
+        const __m128i two = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(current, _mm_set1_epi16(0x1F)), 6), second);
+        const __m128i three = _mm_or_si128(_mm_or_si128(_mm_slli_epi16(current, 12), _mm_slli_epi16(second, 6)), third);
+        __m128i value = _mm_blendv_epi8(current, two, _mm_cmpgt_epi16(current, _mm_set1_epi16(0xBF)));
+        value = _mm_blendv_epi8(value, three, _mm_cmpgt_epi16(current, _mm_set1_epi16(0xDF)));
+        if (is_big)
+        {
+            value = sse2_bswap16(value);
+        }
+
+        // Pack the lanes of the lead bytes four at a time.
+        for (uint32_t quarter = 0; quarter < 2u; quarter++)
+        {
+            const uint32_t mask = (leads >> ((half * 8u) + (quarter * 4u))) & 0xFu;
+            const __m128i lanes = (quarter == 0) ? value : _mm_srli_si128(value, 8);
+            const __m128i packed = _mm_shuffle_epi8(lanes, _mm_loadl_epi64((const __m128i *)pack_words[mask]));
+            _mm_storel_epi64((__m128i *)&words[n], packed);
+            n += (unisize)nibble_bits[mask];
+        }
+    }
+
+    *written = n;
+    return end;
+}
+
+UNICORN_TARGET("sse4.2")
+unisize uni_UTF8_to_UTF16_sse42(const unichar8 *bytes, unisize length, unichar16 *words, unisize capacity, bool is_big, unisize *written)
+{
+    unisize count = 0;
+    unisize n = 0;
+
+    for (;;)
+    {
+        // Runs of ASCII characters are transcoded without validating them first. Each
+        // byte is a code unit therefore the text and buffer advance in lockstep.
+        if ((count < length) && (bytes[count] < (uint8_t)0x80))
+        {
+            const unisize available = ((length - count) < (capacity - n)) ? (length - count) : (capacity - n);
+            const unisize run = uni_ASCII_to_UTF16_sse2(&bytes[count], available, &words[n], is_big);
+            count += run;
+            n += run;
+        }
+
+        // Other text is validated a chunk at a time ahead of transcoding it so the
+        // validated bytes are still in the cache when they're transcoded.
+        const unisize chunk_start = count;
+        const unisize chunk_length = ((length - count) < 4096) ? (length - count) : 4096;
+        const unisize valid_end = count + uni_UTF8_valid_prefix_sse42(&bytes[count], chunk_length);
+
+        // Each block expands to at most 16 code units.
+        while (((valid_end - count) >= 16) && ((capacity - n) >= 16))
+        {
+            const __m128i input = _mm_loadu_si128((const __m128i *)&bytes[count]);
+            if (_mm_movemask_epi8(input) == 0)
+            {
+                sse2_store_ASCII_as_UTF16(input, &words[n], is_big);
+                count += 16;
+                n += 16;
+            }
+            else if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_subs_epu8(input, _mm_set1_epi8((char)0xEF)), _mm_setzero_si128())) == 0xFFFF)
+            {
+                // The code units stored past the transcoded ones must not be observable. They
+                // are stored directly if at least 12 more validated bytes, which transcode to
+                // at least four code units, will be written over them. Otherwise the block is
+                // transcoded to a temporary and only the transcoded code units are copied.
+                unisize block_written = 0;
+                if (((valid_end - count) >= 28) && ((capacity - n) >= 28))
+                {
+                    count += sse42_UTF8_block_to_UTF16(&bytes[count], input, &words[n], is_big, &block_written);
+                }
+                else
+                {
+                    unichar16 block[16];
+                    count += sse42_UTF8_block_to_UTF16(&bytes[count], input, block, is_big, &block_written);
+                    (void)memcpy(&words[n], block, sizeof(block[0]) * (size_t)block_written);
+                }
+                n += block_written;
+            }
+            else
+            {
+                // Blocks with four byte sequences are rare and produce surrogate pairs.
+                unisize block_written = 0;
+                count += uni_UTF8_to_UTF16_scalar(&bytes[count], 16, &words[n], capacity - n, is_big, &block_written);
+                n += block_written;
+            }
+        }
+
+        if ((count == chunk_start) || ((capacity - n) < 16))
+        {
+            break;
+        }
+    }
+
+    unisize tail_written = 0;
+    count += uni_UTF8_to_UTF16_scalar(&bytes[count], length - count, &words[n], capacity - n, is_big, &tail_written);
+    *written = n + tail_written;
+    return count;
+}
+
+unisize uni_UTF16_to_UTF8_sse2(const unichar16 *words, unisize length, unichar8 *out, unisize capacity, bool is_big, unisize *written)
+{
+    unisize count = 0;
+    unisize n = 0;
+
+    for (;;)
+    {
+        // Runs of ASCII characters are narrowed in bulk. Each code unit becomes a byte
+        // therefore the text and buffer advance in lockstep.
+        if ((count < length) && ((is_big ? uni_swap16_be(words[count]) : uni_swap16_le(words[count])) < (unichar16)0x80))
+        {
+            const unisize available = ((length - count) < (capacity - n)) ? (length - count) : (capacity - n);
+            const unisize run = uni_UTF16_to_ASCII_sse2(&words[count], available, &out[n], is_big);
+            count += run;
+            n += run;
+        }
+
+        // Each block of eight code units expands to at most 24 bytes.
+        if (((length - count) < 8) || ((capacity - n) < 24))
+        {
+            break;
+        }
+
+        unisize block_written = 0;
+        const unisize block_consumed = uni_UTF16_to_UTF8_scalar(&words[count], 8, &out[n], capacity - n, is_big, &block_written);
+        count += block_consumed;
+        n += block_written;
+        if (block_consumed < 7)
+        {
+            break; // A surrogate pair may straddle the block therefore one code unit can remain.
+        }
+    }
+
+    unisize tail_written = 0;
+    count += uni_UTF16_to_UTF8_scalar(&words[count], length - count, &out[n], capacity - n, is_big, &tail_written);
+    *written = n + tail_written;
+    return count;
+}
+
+// Transcodes a block of eight UTF-16 code units, in native byte order, that are all below
+// U+0800 to UTF-8. Up to 16 bytes are stored, which is up to four past the transcoded
+// ones. Returns the number of bytes written.
+UNICORN_TARGET("sse4.2")
+static unisize sse42_UTF16_block_to_UTF8_2(__m128i input, unichar8 *out)
+{
+    // Each 16-bit lane holds the first byte of the sequence followed by its second byte,
+    // which is discarded for ASCII characters.
+    const __m128i is_multi_byte = _mm_cmpgt_epi16(input, _mm_set1_epi16(0x7F));
+    const __m128i first = _mm_blendv_epi8(input, _mm_or_si128(_mm_srli_epi16(input, 6), _mm_set1_epi16(0xC0)), is_multi_byte);
+    const __m128i second = _mm_or_si128(_mm_and_si128(input, _mm_set1_epi16(0x3F)), _mm_set1_epi16(0x80));
+    const __m128i pairs = _mm_or_si128(first, _mm_slli_epi16(second, 8));
+    const uint32_t multi_byte = (uint32_t)_mm_movemask_epi8(_mm_packs_epi16(is_multi_byte, is_multi_byte));
+
+    const uint32_t lo_mask = multi_byte & 0xFu;
+    const uint32_t hi_mask = (multi_byte >> 4u) & 0xFu;
+    _mm_storel_epi64((__m128i *)&out[0], _mm_shuffle_epi8(pairs, _mm_loadl_epi64((const __m128i *)pack_pairs[lo_mask])));
+    const unisize n = 4 + (unisize)nibble_bits[lo_mask];
+    _mm_storel_epi64((__m128i *)&out[n], _mm_shuffle_epi8(_mm_srli_si128(pairs, 8), _mm_loadl_epi64((const __m128i *)pack_pairs[hi_mask])));
+    return n + 4 + (unisize)nibble_bits[hi_mask];
+}
+
+// Transcodes a block of eight UTF-16 code units, in native byte order, that aren't surrogates
+// to UTF-8. Up to 28 bytes are stored, which is up to four past the transcoded ones.
+// Returns the number of bytes written.
+UNICORN_TARGET("sse4.2")
+static unisize sse42_UTF16_block_to_UTF8_3(__m128i input, unichar8 *out)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i low_6_bits = _mm_set1_epi32(0x3F);
+    const __m128i continuation = _mm_set1_epi32(0x80);
+    uint32_t sequences[8];
+    uint32_t lengths[8];
+    bool all_three_bytes = true;
+
+    for (uint32_t half = 0; half < 2u; half++)
+    {
+        // Each 32-bit lane holds the bytes of the sequence in memory order.
+        const __m128i value = (half == 0) ? _mm_unpacklo_epi16(input, zero) : _mm_unpackhi_epi16(input, zero);
+        const __m128i is_two_bytes = _mm_cmpgt_epi32(value, _mm_set1_epi32(0x7F));
+        const __m128i is_three_bytes = _mm_cmpgt_epi32(value, _mm_set1_epi32(0x7FF));
+
+        const __m128i two = _mm_or_si128(
+            _mm_or_si128(_mm_srli_epi32(value, 6), _mm_set1_epi32(0xC0)),
+            _mm_slli_epi32(_mm_or_si128(_mm_and_si128(value, low_6_bits), continuation), 8));
+        const __m128i three = _mm_or_si128(
+            _mm_or_si128(_mm_srli_epi32(value, 12), _mm_set1_epi32(0xE0)),
+            _mm_or_si128(
+                _mm_slli_epi32(_mm_or_si128(_mm_and_si128(_mm_srli_epi32(value, 6), low_6_bits), continuation), 8),
+                _mm_slli_epi32(_mm_or_si128(_mm_and_si128(value, low_6_bits), continuation), 16)));
+
+        __m128i sequence = _mm_blendv_epi8(value, two, is_two_bytes);
+        sequence = _mm_blendv_epi8(sequence, three, is_three_bytes);
+        _mm_storeu_si128((__m128i *)&sequences[half * 4u], sequence);
+
+        // The comparisons are -1 for true therefore subtracting them counts the bytes.
+        const __m128i length = _mm_sub_epi32(_mm_sub_epi32(_mm_set1_epi32(1), is_two_bytes), is_three_bytes);
+        _mm_storeu_si128((__m128i *)&lengths[half * 4u], length);
+        if (_mm_movemask_ps(_mm_castsi128_ps(is_three_bytes)) != 0xF)
+        {
+            all_three_bytes = false;
+        }
+    }
+
+    unisize n = 0;
+    if (all_three_bytes)
+    {
+        // Text in scripts like Chinese and Japanese consists of three byte sequences only.
+        const __m128i drop_fourth = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+        _mm_storeu_si128((__m128i *)&out[0], _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)&sequences[0]), drop_fourth));
+        _mm_storeu_si128((__m128i *)&out[12], _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)&sequences[4]), drop_fourth));
+        n = 24;
+    }
+    else
+    {
+        // All four bytes of each lane are stored but the output only advances by the length
+        // of its sequence. This relies on x86 being little endian.
+        for (unisize i = 0; i < 8; i++)
+        {
+            (void)memcpy(&out[n], &sequences[i], sizeof(sequences[i]));
+            n += (unisize)lengths[i];
+        }
+    }
+    return n;
+}
+
+UNICORN_TARGET("sse4.2")
+unisize uni_UTF16_to_UTF8_sse42(const unichar16 *words, unisize length, unichar8 *out, unisize capacity, bool is_big, unisize *written)
+{
+    unisize count = 0;
+    unisize n = 0;
+
+    for (;;)
+    {
+        // Runs of ASCII characters are narrowed in bulk. Each code unit becomes a byte
+        // therefore the text and buffer advance in lockstep.
+        if ((count < length) && ((is_big ? uni_swap16_be(words[count]) : uni_swap16_le(words[count])) < (unichar16)0x80))
+        {
+            const unisize available = ((length - count) < (capacity - n)) ? (length - count) : (capacity - n);
+            const unisize run = uni_UTF16_to_ASCII_sse2(&words[count], available, &out[n], is_big);
+            count += run;
+            n += run;
+        }
+
+        // Each block of eight code units expands to at most 24 bytes.
+        if (((length - count) < 8) || ((capacity - n) < 24))
+        {
+            break;
+        }
+
+        __m128i input = _mm_loadu_si128((const __m128i *)&words[count]);
+        if (is_big)
+        {
+            input = sse2_bswap16(input);
+        }
+
+        // The bytes stored past the transcoded ones must not be observable. They're stored
+        // directly if the four code units following the block aren't surrogates and fit in
+        // the buffer because those characters, which encode to at least four bytes, will be
+        // written over them. Otherwise the block is transcoded to a temporary.
+        bool is_followed = false;
+        if (((length - count) >= 12) && ((capacity - n) >= 36))
+        {
+            __m128i following = _mm_loadl_epi64((const __m128i *)&words[count + 8]);
+            if (is_big)
+            {
+                following = sse2_bswap16(following);
+            }
+            const __m128i surrogates = _mm_cmpeq_epi16(_mm_and_si128(following, _mm_set1_epi16((short)0xF800)), _mm_set1_epi16((short)0xD800));
+            is_followed = ((_mm_movemask_epi8(surrogates) & 0xFF) == 0) ? true : false;
+        }
+        unichar8 block[28];
+        unichar8 *dst = is_followed ? &out[n] : block;
+
+        // As signed integers the code units U+8000 through U+FFFF are negative therefore
+        // unsigned comparisons are emulated with saturating subtraction.
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_subs_epu16(input, _mm_set1_epi16(0x7FF)), _mm_setzero_si128())) == 0xFFFF)
+        {
+            const unisize block_written = sse42_UTF16_block_to_UTF8_2(input, dst);
+            if (!is_followed)
+            {
+                (void)memcpy(&out[n], block, (size_t)block_written);
+            }
+            n += block_written;
+            count += 8;
+        }
+        else if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(input, _mm_set1_epi16((short)0xF800)), _mm_set1_epi16((short)0xD800))) == 0)
+        {
+            const unisize block_written = sse42_UTF16_block_to_UTF8_3(input, dst);
+            if (!is_followed)
+            {
+                (void)memcpy(&out[n], block, (size_t)block_written);
+            }
+            n += block_written;
+            count += 8;
+        }
+        else
+        {
+            // Blocks with surrogates are rare and are validated by the scalar implementation.
+            unisize block_written = 0;
+            const unisize block_consumed = uni_UTF16_to_UTF8_scalar(&words[count], 8, &out[n], capacity - n, is_big, &block_written);
+            count += block_consumed;
+            n += block_written;
+            if (block_consumed < 7)
+            {
+                break; // A surrogate pair may straddle the block therefore one code unit can remain.
+            }
+        }
+    }
+
+    unisize tail_written = 0;
+    count += uni_UTF16_to_UTF8_scalar(&words[count], length - count, &out[n], capacity - n, is_big, &tail_written);
+    *written = n + tail_written;
+    return count;
+}
+
+unisize uni_SCALAR_to_ASCII_sse2(const unichar *chars, unisize length, unichar8 *bytes)
+{
+    const __m128i non_ASCII = _mm_set1_epi32((int)0xFFFFFF80);
+    unisize count = 0;
+
+    while ((length - count) >= 16)
+    {
+        const __m128i a = _mm_loadu_si128((const __m128i *)&chars[count + 0]);
+        const __m128i b = _mm_loadu_si128((const __m128i *)&chars[count + 4]);
+        const __m128i c = _mm_loadu_si128((const __m128i *)&chars[count + 8]);
+        const __m128i d = _mm_loadu_si128((const __m128i *)&chars[count + 12]);
+        const __m128i high_bits = _mm_and_si128(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)), non_ASCII);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(high_bits, _mm_setzero_si128())) != 0xFFFF)
+        {
+            break;
+        }
+
+        // The values are small enough that neither pack saturates.
+        const __m128i lo = _mm_packs_epi32(a, b);
+        const __m128i hi = _mm_packs_epi32(c, d);
+        _mm_storeu_si128((__m128i *)&bytes[count], _mm_packus_epi16(lo, hi));
+        count += 16;
+    }
+
+    return count + uni_SCALAR_to_ASCII_scalar(&chars[count], length - count, &bytes[count]);
+}
+
+unisize uni_SCALAR_to_LATIN1_sse2(const unichar *chars, unisize length, unichar8 *bytes)
+{
+    const __m128i non_LATIN1 = _mm_set1_epi32((int)0xFFFFFF00);
+    unisize count = 0;
+
+    while ((length - count) >= 16)
+    {
+        const __m128i a = _mm_loadu_si128((const __m128i *)&chars[count + 0]);
+        const __m128i b = _mm_loadu_si128((const __m128i *)&chars[count + 4]);
+        const __m128i c = _mm_loadu_si128((const __m128i *)&chars[count + 8]);
+        const __m128i d = _mm_loadu_si128((const __m128i *)&chars[count + 12]);
+        const __m128i high_bits = _mm_and_si128(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)), non_LATIN1);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(high_bits, _mm_setzero_si128())) != 0xFFFF)
+        {
+            break;
+        }
+
+        const __m128i lo = _mm_packs_epi32(a, b);
+        const __m128i hi = _mm_packs_epi32(c, d);
+        _mm_storeu_si128((__m128i *)&bytes[count], _mm_packus_epi16(lo, hi));
+        count += 16;
+    }
+
+    return count + uni_SCALAR_to_LATIN1_scalar(&chars[count], length - count, &bytes[count]);
+}
+
+unisize uni_SCALAR_to_UTF16_sse2(const unichar *chars, unisize length, unichar16 *words, bool is_big)
+{
+    const __m128i supplementary = _mm_set1_epi32((int)0xFFFF0000);
+    const __m128i bias32 = _mm_set1_epi32(0x8000);
+    const __m128i bias16 = _mm_set1_epi16((short)0x8000);
+    unisize count = 0;
+
+    while ((length - count) >= 8)
+    {
+        const __m128i a = _mm_loadu_si128((const __m128i *)&chars[count + 0]);
+        const __m128i b = _mm_loadu_si128((const __m128i *)&chars[count + 4]);
+        const __m128i high_bits = _mm_and_si128(_mm_or_si128(a, b), supplementary);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(high_bits, _mm_setzero_si128())) != 0xFFFF)
+        {
+            break;
+        }
+
+        // The pack instruction saturates signed values, therefore the values are biased
+        // into the signed 16-bit range before packing and unbiased afterwards.
+        __m128i packed = _mm_packs_epi32(_mm_sub_epi32(a, bias32), _mm_sub_epi32(b, bias32));
+        packed = _mm_add_epi16(packed, bias16);
+        if (is_big)
+        {
+            packed = _mm_or_si128(_mm_slli_epi16(packed, 8), _mm_srli_epi16(packed, 8));
+        }
+        _mm_storeu_si128((__m128i *)&words[count], packed);
+        count += 8;
+    }
+
+    return count + uni_SCALAR_to_UTF16_scalar(&chars[count], length - count, &words[count], is_big);
+}
+
+// Returns the sum of the unsigned bytes of the vector.
+static inline unisize sse2_sum_bytes(__m128i v)
+{
+    const __m128i sums = _mm_sad_epu8(v, _mm_setzero_si128());
+    return (unisize)_mm_cvtsi128_si32(sums) + (unisize)_mm_cvtsi128_si32(_mm_srli_si128(sums, 8));
+}
+
+// Returns the sum of the signed 16-bit lanes of the vector.
+static inline unisize sse2_sum_words(__m128i v)
+{
+    const __m128i sums = _mm_madd_epi16(v, _mm_set1_epi16(1));
+    const __m128i pairs = _mm_add_epi32(sums, _mm_srli_si128(sums, 8));
+    return (unisize)_mm_cvtsi128_si32(_mm_add_epi32(pairs, _mm_srli_si128(pairs, 4)));
+}
+
+unisize uni_UTF8_count_sse2(const unichar8 *bytes, unisize length, unisize *supplementary)
+{
+    // Every byte except continuation bytes (10xxxxxx) begins a character.
+    // As signed integers, continuation bytes are those less than or equal to 0xBF.
+    const __m128i last_continuation = _mm_set1_epi8((char)0xBF);
+    const __m128i four_byte_lead = _mm_set1_epi8((char)0xF0);
+    unisize chars = 0;
+    unisize supp = 0;
+    unisize offset = 0;
+
+    while ((length - offset) >= 16)
+    {
+        // The per-byte counters are flushed before they can overflow.
+        __m128i chars_acc = _mm_setzero_si128();
+        __m128i supp_acc = _mm_setzero_si128();
+        for (int32_t i = 0; (i < 255) && ((length - offset) >= 16); i++)
+        {
+            const __m128i input = _mm_loadu_si128((const __m128i *)&bytes[offset]);
+            chars_acc = _mm_sub_epi8(chars_acc, _mm_cmpgt_epi8(input, last_continuation));
+            supp_acc = _mm_sub_epi8(supp_acc, _mm_cmpeq_epi8(_mm_and_si128(input, four_byte_lead), four_byte_lead));
+            offset += 16;
+        }
+        chars += sse2_sum_bytes(chars_acc);
+        supp += sse2_sum_bytes(supp_acc);
+    }
+
+    unisize tail_supp = 0;
+    chars += uni_UTF8_count_scalar(&bytes[offset], length - offset, &tail_supp);
+    *supplementary = supp + tail_supp;
+    return chars;
+}
+
+unisize uni_UTF16_count_sse2(const unichar16 *words, unisize length, bool is_big, unisize *bytes_length)
+{
+    const __m128i ascii_mask = _mm_set1_epi16((short)0xFF80);
+    const __m128i surrogate_mask = _mm_set1_epi16((short)0xF800);
+    const __m128i high_mask = _mm_set1_epi16((short)0xFC00);
+    const __m128i surrogate = _mm_set1_epi16((short)0xD800);
+    const __m128i low = _mm_set1_epi16((short)0xDC00);
+    unisize highs = 0;
+    unisize units = 0;
+    unisize offset = 0;
+    bool is_valid = true;
+
+    // The first code unit must not be a low surrogate. Afterwards, the text is
+    // well-formed if and only if every high surrogate is followed by a low
+    // surrogate and every low surrogate is preceded by a high surrogate.
+    if (length > 0)
+    {
+        const unichar16 first = is_big ? uni_swap16_be(words[0]) : uni_swap16_le(words[0]);
+        is_valid = (first & (unichar16)0xFC00) != (unichar16)0xDC00;
+    }
+
+    // Each block also reads the code unit that follows it.
+    while (is_valid && ((length - offset) > 8))
+    {
+        // The per-lane counters are flushed before they can overflow.
+        __m128i high_acc = _mm_setzero_si128();
+        __m128i units_acc = _mm_setzero_si128();
+        for (int32_t i = 0; (i < 8192) && ((length - offset) > 8); i++)
+        {
+            __m128i input = _mm_loadu_si128((const __m128i *)&words[offset]);
+            __m128i next = _mm_loadu_si128((const __m128i *)&words[offset + 1]);
+            if (is_big)
+            {
+                input = _mm_or_si128(_mm_slli_epi16(input, 8), _mm_srli_epi16(input, 8));
+                next = _mm_or_si128(_mm_slli_epi16(next, 8), _mm_srli_epi16(next, 8));
+            }
+
+            const __m128i is_high = _mm_cmpeq_epi16(_mm_and_si128(input, high_mask), surrogate);
+            const __m128i is_low_next = _mm_cmpeq_epi16(_mm_and_si128(next, high_mask), low);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(is_high, is_low_next)) != 0xFFFF)
+            {
+                is_valid = false;
+                break;
+            }
+
+            // Code units encode as three bytes of UTF-8 minus one for each of:
+            // being ASCII, being less than U+0800, and being a surrogate.
+            const __m128i is_ascii = _mm_cmpeq_epi16(_mm_and_si128(input, ascii_mask), _mm_setzero_si128());
+            const __m128i is_two = _mm_cmpeq_epi16(_mm_and_si128(input, surrogate_mask), _mm_setzero_si128());
+            const __m128i is_surrogate = _mm_cmpeq_epi16(_mm_and_si128(input, surrogate_mask), surrogate);
+            units_acc = _mm_add_epi16(units_acc, _mm_add_epi16(_mm_add_epi16(is_ascii, is_two), is_surrogate));
+            high_acc = _mm_sub_epi16(high_acc, is_high);
+            offset += 8;
+        }
+        highs += sse2_sum_words(high_acc);
+        units += sse2_sum_words(units_acc);
+    }
+
+    // The scalar implementation cannot begin with a low surrogate, therefore
+    // a high surrogate ending the last block is left for it to count.
+    if (is_valid && (offset > 0))
+    {
+        const unichar16 last = is_big ? uni_swap16_be(words[offset - 1]) : uni_swap16_le(words[offset - 1]);
+        if ((last & (unichar16)0xFC00) == (unichar16)0xD800)
+        {
+            offset -= 1;
+            highs -= 1;
+            units += 1;
+        }
+    }
+
+    unisize count = -1;
+    if (is_valid)
+    {
+        // The characters are the code units less the high surrogates.
+        // The 'units' are negative adjustments to three bytes per code unit.
+        unisize tail_bytes = 0;
+        const unisize tail = uni_UTF16_count_scalar(&words[offset], length - offset, is_big, &tail_bytes);
+        if (tail >= 0)
+        {
+            count = (offset - highs) + tail;
+            *bytes_length = (3 * offset) + units + tail_bytes;
+        }
+    }
+    return count;
+}
+
+// Reverses the byte order of each 16-bit lane of the vector.
+static inline __m128i sse2_swap16(__m128i v)
+{
+    return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+}
+
+// Reverses the byte order of each 32-bit lane of the vector.
+static inline __m128i sse2_swap32(__m128i v)
+{
+    const __m128i halves = sse2_swap16(v);
+    return _mm_shufflehi_epi16(_mm_shufflelo_epi16(halves, 0xB1), 0xB1);
+}
+
+// Returns true if the code unit is a high surrogate, which cannot end a copied prefix.
+static inline bool ends_with_high_surrogate(const unichar16 *src, unisize length, bool is_big)
+{
+    bool is_high = false;
+    if (length > 0)
+    {
+        const unichar16 word = is_big ? uni_swap16_be(src[length - 1]) : uni_swap16_le(src[length - 1]);
+        is_high = (word & (unichar16)0xFC00) == (unichar16)0xD800;
+    }
+    return is_high;
+}
+
+unisize uni_UTF16_copy_sse2(const unichar16 *src, unisize length, unichar16 *dst, bool is_big, bool swap)
+{
+    const __m128i high_mask = _mm_set1_epi16((short)0xFC00);
+    const __m128i high = _mm_set1_epi16((short)0xD800);
+    const __m128i low = _mm_set1_epi16((short)0xDC00);
+    unisize offset = 0;
+
+    // The text is well-formed if every high surrogate is followed by a low surrogate
+    // and every low surrogate is preceded by a high surrogate. The first code unit
+    // has no predecessor, therefore it is checked by the scalar implementation.
+    if (uni_UTF16_copy_scalar(src, (length > 0) ? 1 : 0, dst, is_big, swap) == 1)
+    {
+        // Each block also reads the code unit that follows it.
+        while ((length - offset) > 8)
+        {
+            const __m128i raw = _mm_loadu_si128((const __m128i *)&src[offset]);
+            const __m128i raw_next = _mm_loadu_si128((const __m128i *)&src[offset + 1]);
+            const __m128i input = is_big ? sse2_swap16(raw) : raw;
+            const __m128i next = is_big ? sse2_swap16(raw_next) : raw_next;
+
+            const __m128i is_high = _mm_cmpeq_epi16(_mm_and_si128(input, high_mask), high);
+            const __m128i is_low_next = _mm_cmpeq_epi16(_mm_and_si128(next, high_mask), low);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(is_high, is_low_next)) != 0xFFFF)
+            {
+                break;
+            }
+
+            _mm_storeu_si128((__m128i *)&dst[offset], swap ? sse2_swap16(raw) : raw);
+            offset += 8;
+        }
+    }
+
+    // Do not split a surrogate pair between the blocks and the scalar tail.
+    if (ends_with_high_surrogate(src, offset, is_big))
+    {
+        offset -= 1;
+    }
+
+    return offset + uni_UTF16_copy_scalar(&src[offset], length - offset, &dst[offset], is_big, swap);
+}
+
+unisize uni_UTF32_copy_sse2(const unichar32 *src, unisize length, unichar32 *dst, bool is_big, bool swap)
+{
+    // Unsigned comparisons are performed as signed comparisons with the sign bit flipped.
+    const __m128i sign = _mm_set1_epi32((int)0x80000000);
+    const __m128i largest = _mm_set1_epi32((int)(0x10FFFFu ^ 0x80000000u));
+    const __m128i surrogate_mask = _mm_set1_epi32((int)0xFFFFF800);
+    const __m128i surrogate = _mm_set1_epi32(0xD800);
+    unisize offset = 0;
+
+    while ((length - offset) >= 4)
+    {
+        const __m128i raw = _mm_loadu_si128((const __m128i *)&src[offset]);
+        const __m128i input = is_big ? sse2_swap32(raw) : raw;
+        const __m128i too_large = _mm_cmpgt_epi32(_mm_xor_si128(input, sign), largest);
+        const __m128i is_surrogate = _mm_cmpeq_epi32(_mm_and_si128(input, surrogate_mask), surrogate);
+        if (_mm_movemask_epi8(_mm_or_si128(too_large, is_surrogate)) != 0)
+        {
+            break;
+        }
+
+        _mm_storeu_si128((__m128i *)&dst[offset], swap ? sse2_swap32(raw) : raw);
+        offset += 4;
+    }
+
+    return offset + uni_UTF32_copy_scalar(&src[offset], length - offset, &dst[offset], is_big, swap);
+}
+
+// Reverses the byte order of each 16-bit or 32-bit lane of the vector.
+UNICORN_TARGET("avx2")
+static inline __m256i avx2_swap(__m256i v, bool is_utf16)
+{
+    const __m256i swap16 = _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14, 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+    const __m256i swap32 = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    return _mm256_shuffle_epi8(v, is_utf16 ? swap16 : swap32);
+}
+
+UNICORN_TARGET("avx2")
+unisize uni_UTF16_copy_avx2(const unichar16 *src, unisize length, unichar16 *dst, bool is_big, bool swap)
+{
+    const __m256i high_mask = _mm256_set1_epi16((short)0xFC00);
+    const __m256i high = _mm256_set1_epi16((short)0xD800);
+    const __m256i low = _mm256_set1_epi16((short)0xDC00);
+    unisize offset = 0;
+
+    if (uni_UTF16_copy_scalar(src, (length > 0) ? 1 : 0, dst, is_big, swap) == 1)
+    {
+        while ((length - offset) > 16)
+        {
+            const __m256i raw = _mm256_loadu_si256((const __m256i *)&src[offset]);
+            const __m256i raw_next = _mm256_loadu_si256((const __m256i *)&src[offset + 1]);
+            const __m256i input = is_big ? avx2_swap(raw, true) : raw;
+            const __m256i next = is_big ? avx2_swap(raw_next, true) : raw_next;
+
+            const __m256i is_high = _mm256_cmpeq_epi16(_mm256_and_si256(input, high_mask), high);
+            const __m256i is_low_next = _mm256_cmpeq_epi16(_mm256_and_si256(next, high_mask), low);
+            if (_mm256_movemask_epi8(_mm256_cmpeq_epi16(is_high, is_low_next)) != -1)
+            {
+                break;
+            }
+
+            _mm256_storeu_si256((__m256i *)&dst[offset], swap ? avx2_swap(raw, true) : raw);
+            offset += 16;
+        }
+    }
+
+    if (ends_with_high_surrogate(src, offset, is_big))
+    {
+        offset -= 1;
+    }
+
+    return offset + uni_UTF16_copy_sse2(&src[offset], length - offset, &dst[offset], is_big, swap);
+}
+
+UNICORN_TARGET("avx2")
+unisize uni_UTF32_copy_avx2(const unichar32 *src, unisize length, unichar32 *dst, bool is_big, bool swap)
+{
+    const __m256i largest = _mm256_set1_epi32(0x10FFFF);
+    const __m256i surrogate_mask = _mm256_set1_epi32((int)0xFFFFF800);
+    const __m256i surrogate = _mm256_set1_epi32(0xD800);
+    unisize offset = 0;
+
+    while ((length - offset) >= 8)
+    {
+        const __m256i raw = _mm256_loadu_si256((const __m256i *)&src[offset]);
+        const __m256i input = is_big ? avx2_swap(raw, false) : raw;
+        const __m256i in_range = _mm256_cmpeq_epi32(_mm256_max_epu32(input, largest), largest);
+        const __m256i is_surrogate = _mm256_cmpeq_epi32(_mm256_and_si256(input, surrogate_mask), surrogate);
+        if (_mm256_movemask_epi8(_mm256_andnot_si256(is_surrogate, in_range)) != -1)
+        {
+            break;
+        }
+
+        _mm256_storeu_si256((__m256i *)&dst[offset], swap ? avx2_swap(raw, false) : raw);
+        offset += 8;
+    }
+
+    return offset + uni_UTF32_copy_sse2(&src[offset], length - offset, &dst[offset], is_big, swap);
+}
+
+#endif
+
+unisize uni_UTF8_valid_prefix_scalar(const unichar8 *bytes, unisize length)
+{
+    // The portable implementation leaves all validation to the caller.
+    (void)bytes;
+    (void)length;
+    return 0;
+}
+
+unisize uni_ASCII_widen_scalar(const unichar8 *bytes, unisize length, unichar *chars)
+{
+    unisize count = 0;
+    while (count < length)
+    {
+        if (bytes[count] >= (uint8_t)0x80)
+        {
+            break;
+        }
+        chars[count] = (unichar)bytes[count];
+        count += 1;
+    }
+    return count;
+}
+
+unisize uni_ASCII_to_UTF16_scalar(const unichar8 *bytes, unisize length, unichar16 *words, bool is_big)
+{
+    unisize count = 0;
+    while (count < length)
+    {
+        if (bytes[count] >= (uint8_t)0x80)
+        {
+            break;
+        }
+        words[count] = is_big ? uni_swap16_be((unichar16)bytes[count]) : uni_swap16_le((unichar16)bytes[count]);
+        count += 1;
+    }
+    return count;
+}
+
+unisize uni_UTF16_to_ASCII_scalar(const unichar16 *words, unisize length, unichar8 *bytes, bool is_big)
+{
+    unisize count = 0;
+    while (count < length)
+    {
+        const unichar16 word = is_big ? uni_swap16_be(words[count]) : uni_swap16_le(words[count]);
+        if (word >= (unichar16)0x80)
+        {
+            break;
+        }
+        bytes[count] = (unichar8)word;
+        count += 1;
+    }
+    return count;
+}
+
+unisize uni_ASCII_prefix_scalar(const unichar8 *bytes, unisize length)
+{
+    unisize count = 0;
+    while ((count < length) && (bytes[count] < (uint8_t)0x80))
+    {
+        count += 1;
+    }
+    return count;
+}
+
+unisize uni_LATIN1_widen_scalar(const unichar8 *bytes, unisize length, unichar *chars)
+{
+    for (unisize i = 0; i < length; i++)
+    {
+        chars[i] = (unichar)bytes[i];
+    }
+    return length;
+}
+
+unisize uni_LATIN1_to_UTF16_scalar(const unichar8 *bytes, unisize length, unichar16 *words, bool is_big)
+{
+    for (unisize i = 0; i < length; i++)
+    {
+        words[i] = is_big ? uni_swap16_be((unichar16)bytes[i]) : uni_swap16_le((unichar16)bytes[i]);
+    }
+    return length;
+}
+
+unisize uni_UTF16_to_LATIN1_scalar(const unichar16 *words, unisize length, unichar8 *bytes, bool is_big)
+{
+    unisize count = 0;
+    while (count < length)
+    {
+        const unichar16 word = is_big ? uni_swap16_be(words[count]) : uni_swap16_le(words[count]);
+        if (word >= (unichar16)0x100)
+        {
+            break;
+        }
+        bytes[count] = (unichar8)word;
+        count += 1;
+    }
+    return count;
+}
+
+unisize uni_LATIN1_to_UTF8_scalar(const unichar8 *bytes, unisize length, unichar8 *out, unisize capacity, unisize *written)
+{
+    unisize count = 0;
+    unisize n = 0;
+    while (count < length)
+    {
+        const unichar8 byte = bytes[count];
+        if (byte < (uint8_t)0x80)
+        {
+            if (n == capacity)
+            {
+                break;
+            }
+            out[n] = byte;
+            n += 1;
+        }
+        else if ((byte >= (uint8_t)0xA0) && ((capacity - n) >= 2))
+        {
+            out[n + 0] = (unichar8)(byte >> 6u) | (uint8_t)0xC0;
+            out[n + 1] = (unichar8)(byte & (uint8_t)0x3F) | (uint8_t)0x80;
+            n += 2;
+        }
+        else
+        {
+            break;
+        }
+        count += 1;
+    }
+    *written = n;
+    return count;
+}
+
+unisize uni_UTF8_to_LATIN1_scalar(const unichar8 *bytes, unisize length, unichar8 *out, unisize *consumed)
+{
+    unisize count = 0;
+    unisize n = 0;
+    while (count < length)
+    {
+        const unichar8 byte = bytes[count];
+        if (byte < (uint8_t)0x80)
+        {
+            out[n] = byte;
+            count += 1;
+        }
+        else if ((byte == (uint8_t)0xC2) || (byte == (uint8_t)0xC3))
+        {
+            // The lead byte 0xC2 with continuation bytes below 0xA0 encodes a C1 control character.
+            if (((length - count) < 2) || ((bytes[count + 1] & (uint8_t)0xC0) != (uint8_t)0x80))
+            {
+                break;
+            }
+            const unichar8 value = (unichar8)((byte & (uint8_t)0x1F) << 6u) | (unichar8)(bytes[count + 1] & (uint8_t)0x3F);
+            if (value < (uint8_t)0xA0)
+            {
+                break;
+            }
+            out[n] = value;
+            count += 2;
+        }
+        else
+        {
+            break;
+        }
+        n += 1;
+    }
+    *consumed = count;
+    return n;
+}
+
+unisize uni_UTF8_to_UTF16_scalar(const unichar8 *bytes, unisize length, unichar16 *words, unisize capacity, bool is_big, unisize *written)
+{
+    unisize count = 0;
+    unisize n = 0;
+    while (count < length)
+    {
+        const unichar8 byte = bytes[count];
+        unichar cp = (unichar)byte;
+        unisize needed = 1;
+
+        // Range of the second byte. It's narrower than 0x80 through 0xBF after some lead
+        // bytes to exclude overlong sequences, surrogates, and values beyond U+10FFFF.
+        unichar8 lower = 0x80;
+        unichar8 upper = 0xBF;
+
+        if (byte < (uint8_t)0x80)
+        {
+            // No Action: ASCII character.
+        }
+        else if ((byte >= (uint8_t)0xC2) && (byte <= (uint8_t)0xDF))
+        {
+            cp = (unichar)byte & UNICHAR_C(0x1F);
+            needed = 2;
+        }
+        else if ((byte >= (uint8_t)0xE0) && (byte <= (uint8_t)0xEF))
+        {
+            cp = (unichar)byte & UNICHAR_C(0x0F);
+            needed = 3;
+            lower = (byte == (uint8_t)0xE0) ? (uint8_t)0xA0 : (uint8_t)0x80;
+            upper = (byte == (uint8_t)0xED) ? (uint8_t)0x9F : (uint8_t)0xBF;
+        }
+        else if ((byte >= (uint8_t)0xF0) && (byte <= (uint8_t)0xF4))
+        {
+            cp = (unichar)byte & UNICHAR_C(0x07);
+            needed = 4;
+            lower = (byte == (uint8_t)0xF0) ? (uint8_t)0x90 : (uint8_t)0x80;
+            upper = (byte == (uint8_t)0xF4) ? (uint8_t)0x8F : (uint8_t)0xBF;
+        }
+        else
+        {
+            break;
+        }
+
+        if ((length - count) < needed)
+        {
+            break;
+        }
+
+        unisize i = 1;
+        while (i < needed)
+        {
+            const unichar8 next = bytes[count + i];
+            if ((next < lower) || (next > upper))
+            {
+                break;
+            }
+            cp = (cp << 6u) | ((unichar)next & UNICHAR_C(0x3F));
+            lower = 0x80;
+            upper = 0xBF;
+            i += 1;
+        }
+
+        const unisize units = (cp > UNICHAR_C(0xFFFF)) ? 2 : 1;
+        if ((i < needed) || ((capacity - n) < units))
+        {
+            break;
+        }
+
+        if (units == 1)
+        {
+            words[n] = is_big ? uni_swap16_be((unichar16)cp) : uni_swap16_le((unichar16)cp);
+        }
+        else
+        {
+            const unichar16 high = (unichar16)(((cp - UNICHAR_C(0x10000)) >> 10u) + UNICHAR_C(0xD800));
+            const unichar16 low = (unichar16)((cp & UNICHAR_C(0x3FF)) + UNICHAR_C(0xDC00));
+            words[n + 0] = is_big ? uni_swap16_be(high) : uni_swap16_le(high);
+            words[n + 1] = is_big ? uni_swap16_be(low) : uni_swap16_le(low);
+        }
+        n += units;
+        count += needed;
+    }
+    *written = n;
+    return count;
+}
+
+unisize uni_UTF16_to_UTF8_scalar(const unichar16 *words, unisize length, unichar8 *out, unisize capacity, bool is_big, unisize *written)
+{
+    unisize count = 0;
+    unisize n = 0;
+    while (count < length)
+    {
+        const unichar16 word = is_big ? uni_swap16_be(words[count]) : uni_swap16_le(words[count]);
+        unichar cp = (unichar)word;
+        unisize units = 1;
+        unisize needed = 3;
+
+        if (word < (unichar16)0x80)
+        {
+            needed = 1;
+        }
+        else if (word < (unichar16)0x800)
+        {
+            needed = 2;
+        }
+        else if ((word & (unichar16)0xF800) != (unichar16)0xD800)
+        {
+            // No Action: three byte sequence.
+        }
+        else
+        {
+            // A high surrogate followed by a low surrogate is the only valid surrogate sequence.
+            if (((word & (unichar16)0xFC00) != (unichar16)0xD800) || ((count + 1) == length))
+            {
+                break;
+            }
+
+            const unichar16 next = is_big ? uni_swap16_be(words[count + 1]) : uni_swap16_le(words[count + 1]);
+            if ((next & (unichar16)0xFC00) != (unichar16)0xDC00)
+            {
+                break;
+            }
+            cp = ((((unichar)word & UNICHAR_C(0x3FF)) << 10u) | ((unichar)next & UNICHAR_C(0x3FF))) + UNICHAR_C(0x10000);
+            units = 2;
+            needed = 4;
+        }
+
+        if ((capacity - n) < needed)
+        {
+            break;
+        }
+
+        switch (needed)
+        {
+        case 1:
+            out[n + 0] = (unichar8)cp;
+            break;
+
+        case 2:
+            out[n + 0] = (unichar8)(cp >> 6u) | (uint8_t)0xC0;
+            out[n + 1] = (unichar8)(cp & UNICHAR_C(0x3F)) | (uint8_t)0x80;
+            break;
+
+        case 3:
+            out[n + 0] = (unichar8)(cp >> 12u) | (uint8_t)0xE0;
+            out[n + 1] = (unichar8)((cp >> 6u) & UNICHAR_C(0x3F)) | (uint8_t)0x80;
+            out[n + 2] = (unichar8)(cp & UNICHAR_C(0x3F)) | (uint8_t)0x80;
+            break;
+
+        default:
+            out[n + 0] = (unichar8)(cp >> 18u) | (uint8_t)0xF0;
+            out[n + 1] = (unichar8)((cp >> 12u) & UNICHAR_C(0x3F)) | (uint8_t)0x80;
+            out[n + 2] = (unichar8)((cp >> 6u) & UNICHAR_C(0x3F)) | (uint8_t)0x80;
+            out[n + 3] = (unichar8)(cp & UNICHAR_C(0x3F)) | (uint8_t)0x80;
+            break;
+        }
+        n += needed;
+        count += units;
+    }
+    *written = n;
+    return count;
+}
+
+unisize uni_SCALAR_to_ASCII_scalar(const unichar *chars, unisize length, unichar8 *bytes)
+{
+    unisize count = 0;
+    while ((count < length) && (chars[count] < UNICHAR_C(0x80)))
+    {
+        bytes[count] = (unichar8)chars[count];
+        count += 1;
+    }
+    return count;
+}
+
+unisize uni_SCALAR_to_LATIN1_scalar(const unichar *chars, unisize length, unichar8 *bytes)
+{
+    unisize count = 0;
+    while ((count < length) && (chars[count] <= UNICHAR_C(0xFF)))
+    {
+        bytes[count] = (unichar8)chars[count];
+        count += 1;
+    }
+    return count;
+}
+
+unisize uni_SCALAR_to_UTF16_scalar(const unichar *chars, unisize length, unichar16 *words, bool is_big)
+{
+    unisize count = 0;
+    while ((count < length) && (chars[count] <= UNICHAR_C(0xFFFF)))
+    {
+        words[count] = is_big ? uni_swap16_be((unichar16)chars[count]) : uni_swap16_le((unichar16)chars[count]);
+        count += 1;
+    }
+    return count;
+}
+
+unisize uni_UTF8_count_scalar(const unichar8 *bytes, unisize length, unisize *supplementary)
+{
+    unisize chars = 0;
+    unisize supp = 0;
+    for (unisize i = 0; i < length; i++)
+    {
+        if ((bytes[i] & (uint8_t)0xC0) != (uint8_t)0x80)
+        {
+            chars += 1;
+        }
+
+        if (bytes[i] >= (uint8_t)0xF0)
+        {
+            supp += 1;
+        }
+    }
+    *supplementary = supp;
+    return chars;
+}
+
+unisize uni_UTF16_count_scalar(const unichar16 *words, unisize length, bool is_big, unisize *bytes_length)
+{
+    unisize chars = 0;
+    unisize bytes = 0;
+    unisize i = 0;
+
+    while (i < length)
+    {
+        const unichar16 word = is_big ? uni_swap16_be(words[i]) : uni_swap16_le(words[i]);
+        if (word < (unichar16)0x80)
+        {
+            bytes += 1;
+        }
+        else if (word < (unichar16)0x800)
+        {
+            bytes += 2;
+        }
+        else if ((word & (unichar16)0xF800) != (unichar16)0xD800)
+        {
+            bytes += 3;
+        }
+        else if ((word & (unichar16)0xFC00) == (unichar16)0xDC00)
+        {
+            break; // Unpaired low surrogate.
+        }
+        else if ((i + 1) == length)
+        {
+            break; // Unpaired high surrogate.
+        }
+        else
+        {
+            const unichar16 next = is_big ? uni_swap16_be(words[i + 1]) : uni_swap16_le(words[i + 1]);
+            if ((next & (unichar16)0xFC00) != (unichar16)0xDC00)
+            {
+                break; // Unpaired high surrogate.
+            }
+            bytes += 4;
+            i += 1;
+        }
+        chars += 1;
+        i += 1;
+    }
+
+    if (i == length)
+    {
+        *bytes_length = bytes;
+    }
+    else
+    {
+        chars = -1;
+    }
+    return chars;
+}
+
+unisize uni_UTF16_copy_scalar(const unichar16 *src, unisize length, unichar16 *dst, bool is_big, bool swap)
+{
+    unisize count = 0;
+    while (count < length)
+    {
+        const unichar16 word = is_big ? uni_swap16_be(src[count]) : uni_swap16_le(src[count]);
+        unisize units = 1;
+        if ((word & (unichar16)0xF800) == (unichar16)0xD800)
+        {
+            // A high surrogate followed by a low surrogate is the only valid surrogate sequence.
+            if ((word & (unichar16)0xFC00) != (unichar16)0xD800)
+            {
+                break;
+            }
+
+            if ((count + 1) == length)
+            {
+                break;
+            }
+
+            const unichar16 next = is_big ? uni_swap16_be(src[count + 1]) : uni_swap16_le(src[count + 1]);
+            if ((next & (unichar16)0xFC00) != (unichar16)0xDC00)
+            {
+                break;
+            }
+            units = 2;
+        }
+
+        for (unisize i = count; i < (count + units); i++)
+        {
+            dst[i] = swap ? uni_swap16(src[i]) : src[i];
+        }
+        count += units;
+    }
+    return count;
+}
+
+unisize uni_UTF32_copy_scalar(const unichar32 *src, unisize length, unichar32 *dst, bool is_big, bool swap)
+{
+    unisize count = 0;
+    while (count < length)
+    {
+        const unichar32 cp = is_big ? uni_swap32_be(src[count]) : uni_swap32_le(src[count]);
+        if ((cp > (unichar32)0x10FFFF) || ((cp & (unichar32)0xFFFFF800) == (unichar32)0xD800))
+        {
+            break;
+        }
+        dst[count] = swap ? uni_swap32(src[count]) : src[count];
+        count += 1;
+    }
+    return count;
+}
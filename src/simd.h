@@ -0,0 +1,158 @@
+/*
+ *  Unicorn - Embeddable Unicode Algorithms
+ *  Copyright (c) 2024-2026 Railgun Labs
+ *
+ *  This software is dual-licensed: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation. For the terms of this
+ *  license, see <https://www.gnu.org/licenses/>.
+ *
+ *  Alternatively, you can license this software under a proprietary
+ *  license, as set out in <https://railgunlabs.com/unicorn/license/>.
+ */
+
+#ifndef SIMD_H
+#define SIMD_H
+
+#include "common.h"
+#include "unidata.h"
+
+// Vectorized kernels are only compiled for x86-64 targets built with a
+// compiler that supports per-function instruction set selection. They are
+// excluded from size optimized builds and can be disabled entirely by
+// defining UNICORN_NO_SIMD. The portable scalar implementations are always
+// available as a fallback.
+#if !defined(UNICORN_NO_SIMD) && !defined(UNICORN_OPTIMIZE_FOR_SIZE)
+#if defined(__x86_64__) || defined(_M_X64)
+#if defined(__GNUC__) || defined(__clang__)
+#define UNICORN_HAVE_X86_SIMD
+#define UNICORN_TARGET(ISA) __attribute__((target(ISA)))
+#elif defined(_MSC_VER)
+#define UNICORN_HAVE_X86_SIMD
+#define UNICORN_TARGET(ISA)
+#endif
+#endif
+#endif
+
+// The following are implementations of the bulk processing kernels. Each kernel has
+// a portable scalar implementation and, optionally, vectorized implementations for
+// specific instruction sets. Callers should not call them directly but rather obtain
+// the best implementation for the running CPU from uni_kernels().
+
+// Returns the length of the longest prefix of the UTF-8 encoded text that is
+// verified to be well-formed and ends on a code point boundary. The returned
+// length may be shorter than the longest such prefix; the remaining bytes must
+// be validated by the caller.
+unisize uni_UTF8_valid_prefix_scalar(const unichar8 *bytes, unisize length);
+
+// Widens the leading ASCII characters of the text to scalar values. At most 'length'
+// bytes are widened. Returns the number of characters written to 'chars'.
+unisize uni_ASCII_widen_scalar(const unichar8 *bytes, unisize length, unichar *chars);
+
+// Widens the leading ASCII characters of the text to UTF-16 code units in the
+// specified byte order. Returns the number of code units written to 'words'.
+unisize uni_ASCII_to_UTF16_scalar(const unichar8 *bytes, unisize length, unichar16 *words, bool is_big);
+
+// Narrows the leading ASCII characters of the UTF-16 text, which is in the specified
+// byte order, to single bytes. Returns the number of bytes written to 'bytes'.
+unisize uni_UTF16_to_ASCII_scalar(const unichar16 *words, unisize length, unichar8 *bytes, bool is_big);
+
+// Returns the number of leading ASCII characters in the text. These bytes are identical
+// in UTF-8, ISO-8859-1, and Windows-1252.
+unisize uni_ASCII_prefix_scalar(const unichar8 *bytes, unisize length);
+
+// Widens the ISO-8859-1 text to scalar values. Every byte is a character, therefore
+// all 'length' bytes are widened. Returns the number of characters written to 'chars'.
+unisize uni_LATIN1_widen_scalar(const unichar8 *bytes, unisize length, unichar *chars);
+
+// Widens the ISO-8859-1 text to UTF-16 code units in the specified byte order.
+// Returns the number of code units written to 'words'.
+unisize uni_LATIN1_to_UTF16_scalar(const unichar8 *bytes, unisize length, unichar16 *words, bool is_big);
+
+// Narrows the leading characters of the UTF-16 text, which is in the specified byte
+// order, that fit in ISO-8859-1. Returns the number of bytes written to 'bytes'.
+unisize uni_UTF16_to_LATIN1_scalar(const unichar16 *words, unisize length, unichar8 *bytes, bool is_big);
+
+// Transcodes the leading ISO-8859-1 text to UTF-8 writing at most 'capacity' bytes to 'out'.
+// Stops at the C1 control bytes 0x80 through 0x9F because they are printable characters in
+// Windows-1252, which lets that encoding share this kernel. The number of bytes written to
+// 'out' is stored in 'written'. Returns the number of bytes transcoded from 'bytes'.
+unisize uni_LATIN1_to_UTF8_scalar(const unichar8 *bytes, unisize length, unichar8 *out, unisize capacity, unisize *written);
+
+// Transcodes the leading UTF-8 text that encodes ASCII characters and the characters U+00A0
+// through U+00FF, which are identical in ISO-8859-1 and Windows-1252. The number of bytes
+// transcoded from 'bytes' is stored in 'consumed'. Returns the number of bytes written to 'out'.
+unisize uni_UTF8_to_LATIN1_scalar(const unichar8 *bytes, unisize length, unichar8 *out, unisize *consumed);
+
+// Transcodes the longest well-formed prefix of the UTF-8 text to UTF-16 code units in the
+// specified byte order writing at most 'capacity' code units to 'words'. Transcoding stops
+// before an ill-formed or truncated sequence so the caller can report or replace it. The
+// number of code units written to 'words' is stored in 'written'. Returns the number of
+// bytes transcoded from 'bytes'.
+unisize uni_UTF8_to_UTF16_scalar(const unichar8 *bytes, unisize length, unichar16 *words, unisize capacity, bool is_big, unisize *written);
+
+// Transcodes the longest well-formed prefix of the UTF-16 text, which is in the specified
+// byte order, to UTF-8 writing at most 'capacity' bytes to 'out'. Transcoding stops before
+// an unpaired surrogate so the caller can report or replace it. The number of bytes written
+// to 'out' is stored in 'written'. Returns the number of code units transcoded from 'words'.
+unisize uni_UTF16_to_UTF8_scalar(const unichar16 *words, unisize length, unichar8 *out, unisize capacity, bool is_big, unisize *written);
+
+// Narrows the leading scalar values that are ASCII characters to bytes.
+// Returns the number of bytes written to 'bytes'.
+unisize uni_SCALAR_to_ASCII_scalar(const unichar *chars, unisize length, unichar8 *bytes);
+
+// Narrows the leading scalar values that fit in ISO-8859-1 to bytes.
+// Returns the number of bytes written to 'bytes'.
+unisize uni_SCALAR_to_LATIN1_scalar(const unichar *chars, unisize length, unichar8 *bytes);
+
+// Narrows the leading scalar values in the Basic Multilingual Plane to UTF-16 code units
+// in the specified byte order. Returns the number of code units written to 'words'.
+unisize uni_SCALAR_to_UTF16_scalar(const unichar *chars, unisize length, unichar16 *words, bool is_big);
+
+// Counts the characters of the well-formed UTF-8 text. The number of characters
+// outside the Basic Multilingual Plane is written to 'supplementary'.
+unisize uni_UTF8_count_scalar(const unichar8 *bytes, unisize length, unisize *supplementary);
+
+// Counts the characters of the UTF-16 text, which is in the specified byte order.
+// The length of the text when encoded as UTF-8 is written to 'bytes_length'.
+// Returns -1 if the text contains an unpaired surrogate.
+unisize uni_UTF16_count_scalar(const unichar16 *words, unisize length, bool is_big, unisize *bytes_length);
+
+// Copies the longest well-formed prefix of the UTF-16 text, which is in the specified byte
+// order, that ends on a code point boundary. The code units are byte swapped if 'swap' is
+// true. Returns the number of code units copied.
+unisize uni_UTF16_copy_scalar(const unichar16 *src, unisize length, unichar16 *dst, bool is_big, bool swap);
+
+// Copies the longest well-formed prefix of the UTF-32 text, which is in the specified byte
+// order. The code units are byte swapped if 'swap' is true. Returns the number of code
+// units copied.
+unisize uni_UTF32_copy_scalar(const unichar32 *src, unisize length, unichar32 *dst, bool is_big, bool swap);
+
+#if defined(UNICORN_HAVE_X86_SIMD)
+unisize uni_UTF8_valid_prefix_sse42(const unichar8 *bytes, unisize length);
+unisize uni_UTF8_valid_prefix_avx2(const unichar8 *bytes, unisize length);
+unisize uni_ASCII_widen_sse2(const unichar8 *bytes, unisize length, unichar *chars);
+unisize uni_ASCII_to_UTF16_sse2(const unichar8 *bytes, unisize length, unichar16 *words, bool is_big);
+unisize uni_UTF16_to_ASCII_sse2(const unichar16 *words, unisize length, unichar8 *bytes, bool is_big);
+unisize uni_ASCII_prefix_sse2(const unichar8 *bytes, unisize length);
+unisize uni_LATIN1_widen_sse2(const unichar8 *bytes, unisize length, unichar *chars);
+unisize uni_LATIN1_to_UTF16_sse2(const unichar8 *bytes, unisize length, unichar16 *words, bool is_big);
+unisize uni_UTF16_to_LATIN1_sse2(const unichar16 *words, unisize length, unichar8 *bytes, bool is_big);
+unisize uni_LATIN1_to_UTF8_sse2(const unichar8 *bytes, unisize length, unichar8 *out, unisize capacity, unisize *written);
+unisize uni_UTF8_to_LATIN1_sse2(const unichar8 *bytes, unisize length, unichar8 *out, unisize *consumed);
+unisize uni_UTF8_to_UTF16_sse2(const unichar8 *bytes, unisize length, unichar16 *words, unisize capacity, bool is_big, unisize *written);
+unisize uni_UTF8_to_UTF16_sse42(const unichar8 *bytes, unisize length, unichar16 *words, unisize capacity, bool is_big, unisize *written);
+unisize uni_UTF16_to_UTF8_sse2(const unichar16 *words, unisize length, unichar8 *out, unisize capacity, bool is_big, unisize *written);
+unisize uni_UTF16_to_UTF8_sse42(const unichar16 *words, unisize length, unichar8 *out, unisize capacity, bool is_big, unisize *written);
+unisize uni_SCALAR_to_ASCII_sse2(const unichar *chars, unisize length, unichar8 *bytes);
+unisize uni_SCALAR_to_LATIN1_sse2(const unichar *chars, unisize length, unichar8 *bytes);
+unisize uni_SCALAR_to_UTF16_sse2(const unichar *chars, unisize length, unichar16 *words, bool is_big);
+unisize uni_UTF8_count_sse2(const unichar8 *bytes, unisize length, unisize *supplementary);
+unisize uni_UTF16_count_sse2(const unichar16 *words, unisize length, bool is_big, unisize *bytes_length);
+unisize uni_UTF16_copy_sse2(const unichar16 *src, unisize length, unichar16 *dst, bool is_big, bool swap);
+unisize uni_UTF16_copy_avx2(const unichar16 *src, unisize length, unichar16 *dst, bool is_big, bool swap);
+unisize uni_UTF32_copy_sse2(const unichar32 *src, unisize length, unichar32 *dst, bool is_big, bool swap);
+unisize uni_UTF32_copy_avx2(const unichar32 *src, unisize length, unichar32 *dst, bool is_big, bool swap);
+#endif
+
+#endif // SIMD_H
@@ -41,7 +41,7 @@ static inline int32_t uni_popcnt(uint32_t n)
 #endif
 }
 
-static unistat check_encoding(uniattr *encoding)
+unistat uni_check_encoding(uniattr *encoding)
 {
     unistat status = UNI_OK;
     const uniattr enc = *encoding;
@@ -100,6 +100,21 @@ unistat uni_check_input_encoding(const void *text, unisize length, uniattr *enco
         uni_message("input buffer incompatible with 'UNI_NULIFY' flag");
         status = UNI_BAD_OPERATION;
     }
+    else if (((*encoding) & UNI_SINK) == UNI_SINK)
+    {
+        uni_message("input buffer incompatible with 'UNI_SINK' flag");
+        status = UNI_BAD_OPERATION;
+    }
+    else if (((*encoding) & (UNI_ALLOC | UNI_SHRINK)) != (uniattr)0)
+    {
+        uni_message("input buffer incompatible with 'UNI_ALLOC' and 'UNI_SHRINK' flags");
+        status = UNI_BAD_OPERATION;
+    }
+    else if (((*encoding) & UNI_CURSOR) == UNI_CURSOR)
+    {
+        uni_message("input buffer incompatible with 'UNI_CURSOR' flag");
+        status = UNI_BAD_OPERATION;
+    }
     else if (text == NULL)
     {
         uni_message("input buffer is null");
@@ -107,7 +122,7 @@ unistat uni_check_input_encoding(const void *text, unisize length, uniattr *enco
     }
     else
     {
-        status = check_encoding(encoding);
+        status = uni_check_encoding(encoding);
     }
 
     return status;
@@ -127,11 +142,44 @@ unistat uni_check_output_encoding(const void *buffer, const unisize *capacity, u
         uni_message("output buffer incompatible with 'UNI_TRUST' flag");
         status = UNI_BAD_OPERATION;
     }
+    else if (((*encoding) & UNI_REPLACE) == UNI_REPLACE)
+    {
+        uni_message("output buffer incompatible with 'UNI_REPLACE' flag");
+        status = UNI_BAD_OPERATION;
+    }
     else if (capacity == NULL)
     {
         uni_message("output buffer capacity is null");
         status = UNI_BAD_OPERATION;
     }
+    else if (uni_popcnt((uint32_t)((*encoding) & (UNI_SINK | UNI_ALLOC | UNI_CURSOR))) > 1)
+    {
+        uni_message("'UNI_SINK', 'UNI_ALLOC', and 'UNI_CURSOR' flags are mutually exclusive");
+        status = UNI_BAD_OPERATION;
+    }
+    else if (((*encoding) & (UNI_SHRINK | UNI_ALLOC)) == UNI_SHRINK)
+    {
+        uni_message("'UNI_SHRINK' flag requires the 'UNI_ALLOC' flag");
+        status = UNI_BAD_OPERATION;
+    }
+    else if ((((*encoding) & UNI_ALLOC) == UNI_ALLOC) && uni_heap_disabled())
+    {
+        uni_message("'UNI_ALLOC' flag is incompatible with the 'UNI_NO_HEAP' context option");
+        status = UNI_BAD_OPERATION;
+    }
+    else if (((*encoding) & (UNI_SINK | UNI_ALLOC | UNI_CURSOR)) != (uniattr)0)
+    {
+        // The capacity is ignored because the sink, allocation, or cursor determines where the output goes.
+        if (buffer == NULL)
+        {
+            uni_message("output sink, allocation, or cursor is null");
+            status = UNI_BAD_OPERATION;
+        }
+        else
+        {
+            status = uni_check_encoding(encoding);
+        }
+    }
     else if (*capacity < 0)
     {
         uni_message("output buffer capacity is negative");
@@ -144,7 +192,7 @@ unistat uni_check_output_encoding(const void *buffer, const unisize *capacity, u
     }
     else
     {
-        status = check_encoding(encoding);
+        status = uni_check_encoding(encoding);
     }
 
     return status;
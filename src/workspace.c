@@ -0,0 +1,95 @@
+/*
+ *  Unicorn - Embeddable Unicode Algorithms
+ *  Copyright (c) 2024-2026 Railgun Labs
+ *
+ *  This software is dual-licensed: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 3 as
+ *  published by the Free Software Foundation. For the terms of this
+ *  license, see <https://www.gnu.org/licenses/>.
+ *
+ *  Alternatively, you can license this software under a proprietary
+ *  license, as set out in <https://railgunlabs.com/unicorn/license/>.
+ */
+
+#include "charvec.h"
+
+static void free_slots(uniworkspace *workspace)
+{
+    for (size_t i = 0; i < COUNT_OF(workspace->slots); i++)
+    {
+        struct WorkspaceSlot *slot = &workspace->slots[i];
+        if (slot->chars != NULL)
+        {
+            uni_global_free(slot->chars, sizeof(slot->chars[0]) * (size_t)slot->capacity);
+        }
+    }
+}
+
+UNICORN_API unistat uni_workspace_create(unisize capacity, uniworkspace **workspace) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+{
+    unistat status = UNI_OK;
+
+    if (workspace == NULL)
+    {
+        uni_message("required argument is null");
+        status = UNI_BAD_OPERATION;
+    }
+    else if (capacity < 0)
+    {
+        uni_message("capacity is negative");
+        status = UNI_BAD_OPERATION;
+    }
+    else
+    {
+        uniworkspace *new_workspace = uni_global_malloc(sizeof(uniworkspace)); // cppcheck-suppress misra-c2012-11.5
+        if (new_workspace == NULL)
+        {
+            uni_message("memory allocation failed");
+            status = UNI_NO_MEMORY;
+        }
+        else
+        {
+            for (size_t i = 0; i < COUNT_OF(new_workspace->slots); i++)
+            {
+                struct WorkspaceSlot *slot = &new_workspace->slots[i];
+                slot->chars = NULL;
+                slot->capacity = 0;
+                slot->in_use = false;
+
+                // Capacities that fit the stack buffers of the character vectors need no storage.
+                if ((status == UNI_OK) && (capacity > UNICORN_STACK_BUFFER_SIZE))
+                {
+                    slot->chars = uni_global_malloc(sizeof(slot->chars[0]) * (size_t)capacity); // cppcheck-suppress misra-c2012-11.5
+                    if (slot->chars == NULL)
+                    {
+                        uni_message("memory allocation failed");
+                        status = UNI_NO_MEMORY;
+                    }
+                    else
+                    {
+                        slot->capacity = capacity;
+                    }
+                }
+            }
+
+            if (status != UNI_OK)
+            {
+                free_slots(new_workspace);
+                uni_global_free(new_workspace, sizeof(uniworkspace));
+                new_workspace = NULL;
+            }
+        }
+        *workspace = new_workspace;
+    }
+
+    return status;
+}
+
+UNICORN_API void uni_workspace_destroy(uniworkspace *workspace) // cppcheck-suppress misra-c2012-8.7 ; This is supposed to have external linkage.
+{
+    if (workspace != NULL)
+    {
+        free_slots(workspace);
+        uni_global_free(workspace, sizeof(uniworkspace));
+    }
+}